@@ -601,4 +601,158 @@ void set_difference(Iterator first1, Iterator last1, Iterator first2, Iterator l
     free(val2);
 }
 
+// Span操作
+// 查找失败时返回span_end(span)
+void span_for_each(Span span, UnaryFunction func) {
+    char* ptr = span.data;
+    for (size_t i = 0; i < span.count; i++, ptr += span.stride) {
+        func(ptr);
+    }
+}
+
+void* span_find_mem(Span span, const void* value) {
+    char* ptr = span.data;
+    for (size_t i = 0; i < span.count; i++, ptr += span.stride) {
+        if (memcmp(ptr, value, span.stride) == 0) {
+            return ptr;
+        }
+    }
+    return ptr;
+}
+
+void* span_find_if(Span span, UnaryPredicate pred) {
+    char* ptr = span.data;
+    for (size_t i = 0; i < span.count; i++, ptr += span.stride) {
+        if (pred(ptr)) {
+            return ptr;
+        }
+    }
+    return ptr;
+}
+
+size_t span_count_if(Span span, UnaryPredicate pred) {
+    size_t count = 0;
+    char* ptr = span.data;
+    for (size_t i = 0; i < span.count; i++, ptr += span.stride) {
+        if (pred(ptr)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void span_fill(Span span, const void* value) {
+    if (span.count == 0) return;
+
+    // 先写入一个元素，再按已填充的长度倍增复制
+    char* ptr = span.data;
+    size_t total = span.count * span.stride;
+    size_t filled = span.stride;
+    memcpy(ptr, value, span.stride);
+    while (filled < total) {
+        size_t n = filled < total - filled ? filled : total - filled;
+        memcpy(ptr + filled, ptr, n);
+        filled += n;
+    }
+}
+
+// 分段交换两个不重叠的元素，避免为临时变量分配堆内存
+static void swap_bytes(char* a, char* b, size_t size) {
+    char temp[64];
+    while (size > 0) {
+        size_t n = size < sizeof(temp) ? size : sizeof(temp);
+        memcpy(temp, a, n);
+        memcpy(a, b, n);
+        memcpy(b, temp, n);
+        a += n;
+        b += n;
+        size -= n;
+    }
+}
+
+void span_reverse(Span span) {
+    if (span.count < 2) return;
+    char* left = span.data;
+    char* right = span_at(span, span.count - 1);
+    while (left < right) {
+        swap_bytes(left, right, span.stride);
+        left += span.stride;
+        right -= span.stride;
+    }
+}
+
+void span_sort(Span span, Compare comp) {
+    if (span.count < 2) return;
+    qsort(span.data, span.count, span.stride, comp);
+}
+
+bool span_is_sorted(Span span, Compare comp) {
+    char* ptr = span.data;
+    for (size_t i = 1; i < span.count; i++, ptr += span.stride) {
+        if (comp(ptr + span.stride, ptr) < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void* span_lower_bound(Span span, const void* value, Compare comp) {
+    size_t first = 0;
+    size_t count = span.count;
+    while (count > 0) {
+        size_t step = count / 2;
+        if (comp(span_at(span, first + step), value) < 0) {
+            first += step + 1;
+            count -= step + 1;
+        }
+        else {
+            count = step;
+        }
+    }
+    return span_at(span, first);
+}
 
+void* span_upper_bound(Span span, const void* value, Compare comp) {
+    size_t first = 0;
+    size_t count = span.count;
+    while (count > 0) {
+        size_t step = count / 2;
+        if (comp(value, span_at(span, first + step)) >= 0) {
+            first += step + 1;
+            count -= step + 1;
+        }
+        else {
+            count = step;
+        }
+    }
+    return span_at(span, first);
+}
+
+bool span_binary_search(Span span, const void* value, Compare comp) {
+    void* pos = span_lower_bound(span, value, comp);
+    return pos != span_end(span) && comp(value, pos) >= 0;
+}
+
+void* span_min_element(Span span, Compare comp) {
+    if (span.count == 0) return span.data;
+    char* best = span.data;
+    char* ptr = best + span.stride;
+    for (size_t i = 1; i < span.count; i++, ptr += span.stride) {
+        if (comp(ptr, best) < 0) {
+            best = ptr;
+        }
+    }
+    return best;
+}
+
+void* span_max_element(Span span, Compare comp) {
+    if (span.count == 0) return span.data;
+    char* best = span.data;
+    char* ptr = best + span.stride;
+    for (size_t i = 1; i < span.count; i++, ptr += span.stride) {
+        if (comp(best, ptr) < 0) {
+            best = ptr;
+        }
+    }
+    return best;
+}
@@ -1,5 +1,6 @@
 ﻿#pragma once
-#include "core/data_structs/iterator/iterator.h"
+#include "core/data_structs/containers/iterator/iterator.h"
+#include "core/data_structs/containers/span.h"
 #include <stdbool.h>
 // 函数类型定义
 typedef void (*UnaryFunction)(void* elem);
@@ -65,3 +66,18 @@ API void set_intersection(Iterator first1, Iterator last1, Iterator first2, Iter
 API void set_difference(Iterator first1, Iterator last1, Iterator first2, Iterator last2,
     Iterator result, Compare comp);
 
+// Span操作：直接在连续内存上运行，不经过迭代器，也不复制元素
+// 回调收到的是元素地址；修改性操作要求stride等于元素大小
+API void span_for_each(Span span, UnaryFunction func);
+API void* span_find_mem(Span span, const void* value);
+API void* span_find_if(Span span, UnaryPredicate pred);
+API size_t span_count_if(Span span, UnaryPredicate pred);
+API void span_fill(Span span, const void* value);
+API void span_reverse(Span span);
+API void span_sort(Span span, Compare comp);
+API bool span_is_sorted(Span span, Compare comp);
+API void* span_lower_bound(Span span, const void* value, Compare comp);
+API void* span_upper_bound(Span span, const void* value, Compare comp);
+API bool span_binary_search(Span span, const void* value, Compare comp);
+API void* span_min_element(Span span, Compare comp);
+API void* span_max_element(Span span, Compare comp);
@@ -1,20 +1,78 @@
 ﻿#include <stdlib.h>
 #include "allocator.h"
+#ifdef _WIN32
+#include <malloc.h>
+#endif
 
 // 默认的内存分配函数
 static void* default_allocate(size_t size) {
+#ifdef _WIN32
+    // Windows下_aligned_malloc的内存只能由_aligned_free释放，统一走对齐接口
+    return _aligned_malloc(size, ALLOCATOR_DEFAULT_ALIGNMENT);
+#else
     return malloc(size);
+#endif
 }
 
 // 默认的内存释放函数
 static void default_deallocate(void* ptr) {
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
     free(ptr);
+#endif
 }
 
+// v2默认实现
+static void* default_v2_allocate(void* context, size_t size) {
+    (void)context;
+    return default_allocate(size);
+}
+
+static void* default_v2_allocate_aligned(void* context, size_t size, size_t alignment) {
+    (void)context;
+    if (alignment < ALLOCATOR_DEFAULT_ALIGNMENT) {
+        alignment = ALLOCATOR_DEFAULT_ALIGNMENT;
+    }
+#ifdef _WIN32
+    return _aligned_malloc(size, alignment);
+#else
+    // aligned_alloc要求size为alignment的整数倍
+    size = (size + alignment - 1) & ~(alignment - 1);
+    return aligned_alloc(alignment, size);
+#endif
+}
+
+static void* default_v2_reallocate(void* context, void* ptr, size_t old_size, size_t new_size) {
+    (void)context;
+    (void)old_size;
+#ifdef _WIN32
+    return _aligned_realloc(ptr, new_size, ALLOCATOR_DEFAULT_ALIGNMENT);
+#else
+    return realloc(ptr, new_size);
+#endif
+}
+
+static void default_v2_deallocate(void* context, void* ptr, size_t size, size_t alignment) {
+    (void)context;
+    (void)size;
+    (void)alignment;
+    default_deallocate(ptr);
+}
+
+static const AllocatorVTable default_vtable = {
+    .allocate = default_v2_allocate,
+    .allocate_aligned = default_v2_allocate_aligned,
+    .reallocate = default_v2_reallocate,
+    .deallocate = default_v2_deallocate
+};
+
 // 默认分配器实例
 static Allocator default_allocator = {
     .allocate = default_allocate,
-    .deallocate = default_deallocate
+    .deallocate = default_deallocate,
+    .vtable = &default_vtable,
+    .context = NULL
 };
 
 // 当前使用的分配器，初始为默认分配器
@@ -26,4 +84,33 @@ Allocator* get_default_allocator(void) {
 
 void set_default_allocator(Allocator* allocator) {
     current_allocator = allocator ? allocator : &default_allocator;
-}
\ No newline at end of file
+}
+
+Allocator* get_system_allocator(void) {
+    return &default_allocator;
+}
+
+Allocator allocator_make(const AllocatorVTable* vtable, void* context) {
+    Allocator allocator = {
+        .allocate = NULL,
+        .deallocate = NULL,
+        .vtable = vtable,
+        .context = context
+    };
+    return allocator;
+}
+
+void* allocator_legacy_allocate_aligned(Allocator* allocator, size_t size, size_t alignment) {
+    // 额外空间：对齐余量 + 保存原始指针
+    if (size > SIZE_MAX - alignment - sizeof(void*)) return NULL;
+    char* raw = allocator->allocate(size + alignment + sizeof(void*));
+    if (!raw) return NULL;
+
+    uintptr_t aligned = ((uintptr_t)raw + sizeof(void*) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    ((void**)aligned)[-1] = raw;
+    return (void*)aligned;
+}
+
+void allocator_legacy_deallocate_aligned(Allocator* allocator, void* ptr) {
+    allocator->deallocate(((void**)ptr)[-1]);
+}
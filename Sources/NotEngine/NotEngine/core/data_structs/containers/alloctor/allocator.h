@@ -1,15 +1,105 @@
 ﻿#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 #include "typedefs.h"
 
-typedef struct {
-    // 分配内存的函数指针
+// 普通分配保证的对齐（与malloc一致）
+#define ALLOCATOR_DEFAULT_ALIGNMENT (sizeof(void*) * 2)
+
+// v2分配器函数表，context为分配器自身的状态
+typedef struct AllocatorVTable {
+    // 分配size字节，按ALLOCATOR_DEFAULT_ALIGNMENT对齐
+    void* (*allocate)(void* context, size_t size);
+    // 按alignment（2的幂）对齐分配
+    void* (*allocate_aligned)(void* context, size_t size, size_t alignment);
+    // 调整内存块大小，可为NULL（退化为分配+复制+释放）
+    void* (*reallocate)(void* context, void* ptr, size_t old_size, size_t new_size);
+    // 释放内存，size和alignment为分配时的大小和对齐（普通分配为ALLOCATOR_DEFAULT_ALIGNMENT）
+    void (*deallocate)(void* context, void* ptr, size_t size, size_t alignment);
+} AllocatorVTable;
+
+typedef struct Allocator {
+    // 旧接口：分配内存的函数指针
     void* (*allocate)(size_t size);
-    // 释放内存的函数指针
+    // 旧接口：释放内存的函数指针
     void (*deallocate)(void* ptr);
+
+    // v2接口：为NULL时通过旧接口适配
+    const AllocatorVTable* vtable;
+    // v2接口的上下文指针
+    void* context;
 } Allocator;
 
 // 获取默认分配器
 API Allocator* get_default_allocator(void);
 
 // 设置默认分配器
-API void set_default_allocator(Allocator* allocator);
\ No newline at end of file
+API void set_default_allocator(Allocator* allocator);
+
+// 获取基于malloc的系统分配器，不受set_default_allocator影响
+API Allocator* get_system_allocator(void);
+
+// 用函数表和上下文构造v2分配器
+API Allocator allocator_make(const AllocatorVTable* vtable, void* context);
+
+// 旧接口的对齐分配适配：多分配一段空间，在返回地址前保存原始指针
+API void* allocator_legacy_allocate_aligned(Allocator* allocator, size_t size, size_t alignment);
+API void allocator_legacy_deallocate_aligned(Allocator* allocator, void* ptr);
+
+// 以下为容器使用的统一入口，自动在v2与旧接口之间分派
+
+static inline void* allocator_allocate(Allocator* allocator, size_t size) {
+    if (allocator->vtable) {
+        return allocator->vtable->allocate(allocator->context, size);
+    }
+    return allocator->allocate(size);
+}
+
+static inline void* allocator_allocate_aligned(Allocator* allocator, size_t size, size_t alignment) {
+    if (allocator->vtable) {
+        return allocator->vtable->allocate_aligned(allocator->context, size, alignment);
+    }
+    if (alignment <= ALLOCATOR_DEFAULT_ALIGNMENT) {
+        return allocator->allocate(size);
+    }
+    return allocator_legacy_allocate_aligned(allocator, size, alignment);
+}
+
+static inline void allocator_deallocate(Allocator* allocator, void* ptr, size_t size) {
+    if (!ptr) return;
+    if (allocator->vtable) {
+        allocator->vtable->deallocate(allocator->context, ptr, size, ALLOCATOR_DEFAULT_ALIGNMENT);
+        return;
+    }
+    allocator->deallocate(ptr);
+}
+
+// 释放allocator_allocate_aligned得到的内存，alignment须与分配时一致
+static inline void allocator_deallocate_aligned(Allocator* allocator, void* ptr, size_t size, size_t alignment) {
+    if (!ptr) return;
+    if (allocator->vtable) {
+        allocator->vtable->deallocate(allocator->context, ptr, size, alignment);
+        return;
+    }
+    if (alignment <= ALLOCATOR_DEFAULT_ALIGNMENT) {
+        allocator->deallocate(ptr);
+        return;
+    }
+    allocator_legacy_deallocate_aligned(allocator, ptr);
+}
+
+// 调整内存块大小，ptr须来自allocator_allocate
+static inline void* allocator_reallocate(Allocator* allocator, void* ptr, size_t old_size, size_t new_size) {
+    if (allocator->vtable && allocator->vtable->reallocate) {
+        return allocator->vtable->reallocate(allocator->context, ptr, old_size, new_size);
+    }
+
+    void* new_ptr = allocator_allocate(allocator, new_size);
+    if (ptr && new_ptr) {
+        memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+        allocator_deallocate(allocator, ptr, old_size);
+    }
+    return new_ptr;
+}
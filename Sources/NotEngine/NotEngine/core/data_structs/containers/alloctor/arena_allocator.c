@@ -0,0 +1,252 @@
+﻿#include "arena_allocator.h"
+
+#define ARENA_DEFAULT_CHUNK_SIZE (64 * 1024)
+
+// 内存块，数据紧跟在块头之后
+typedef struct ArenaChunk {
+    struct ArenaChunk* next;
+    size_t capacity;
+    size_t used;       // 离开该块时已使用的字节数，被跳过的块为0
+} ArenaChunk;
+
+// 块头大小向上取整，保证数据区按默认对齐
+#define CHUNK_HEADER_SIZE \
+    ((sizeof(ArenaChunk) + ALLOCATOR_DEFAULT_ALIGNMENT - 1) & ~(ALLOCATOR_DEFAULT_ALIGNMENT - 1))
+
+struct ArenaAllocator {
+    Allocator allocator;   // 对外的Allocator接口，context指向自身
+    Allocator* backing;    // 申请块使用的分配器
+    ArenaChunk* first;     // 第一个块
+    ArenaChunk* current;   // 当前分配的块
+    size_t offset;         // 当前块中已使用的字节数
+    size_t chunk_size;     // 默认块大小
+    size_t used_before;    // current之前所有块已使用字节数之和
+    size_t reserved;       // 已申请的总字节数
+    void* last_alloc;      // 最近一次分配，用于原地扩展和回退
+};
+
+struct FrameArena {
+    ArenaAllocator arenas[2];
+    size_t current;
+    Allocator* backing;
+};
+
+static char* chunk_data(ArenaChunk* chunk) {
+    return (char*)chunk + CHUNK_HEADER_SIZE;
+}
+
+static size_t align_offset(ArenaChunk* chunk, size_t offset, size_t alignment) {
+    uintptr_t addr = (uintptr_t)chunk_data(chunk) + offset;
+    uintptr_t aligned = (addr + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    return offset + (size_t)(aligned - addr);
+}
+
+static ArenaChunk* create_chunk(ArenaAllocator arena, size_t capacity) {
+    ArenaChunk* chunk = allocator_allocate(arena->backing, CHUNK_HEADER_SIZE + capacity);
+    if (!chunk) return NULL;
+    chunk->next = NULL;
+    chunk->capacity = capacity;
+    chunk->used = 0;
+    arena->reserved += CHUNK_HEADER_SIZE + capacity;
+    return chunk;
+}
+
+// 当前块空间不足时切换到下一个可用的块
+static bool advance_chunk(ArenaAllocator arena, size_t size, size_t alignment) {
+    size_t needed = size + alignment;
+    size_t used_before = arena->used_before + arena->offset;
+    ArenaChunk* prev = arena->current;
+    ArenaChunk* next = prev->next;
+    prev->used = arena->offset;
+
+    // 优先复用reset/restore后保留下来的块，放不下的块跳过
+    while (next && next->capacity < needed) {
+        next->used = 0;
+        prev = next;
+        next = next->next;
+    }
+
+    if (!next) {
+        size_t capacity = needed > arena->chunk_size ? needed : arena->chunk_size;
+        next = create_chunk(arena, capacity);
+        if (!next) return false;
+        prev->next = next;
+    }
+
+    arena->used_before = used_before;
+    arena->current = next;
+    arena->offset = 0;
+    return true;
+}
+
+void* arena_alloc(ArenaAllocator arena, size_t size, size_t alignment) {
+    if (alignment < ALLOCATOR_DEFAULT_ALIGNMENT) {
+        alignment = ALLOCATOR_DEFAULT_ALIGNMENT;
+    }
+
+    size_t start = align_offset(arena->current, arena->offset, alignment);
+    if (start + size > arena->current->capacity) {
+        if (!advance_chunk(arena, size, alignment)) return NULL;
+        start = align_offset(arena->current, 0, alignment);
+    }
+
+    void* ptr = chunk_data(arena->current) + start;
+    arena->offset = start + size;
+    arena->last_alloc = ptr;
+    return ptr;
+}
+
+// Allocator接口实现
+static void* arena_v2_allocate(void* context, size_t size) {
+    return arena_alloc(context, size, ALLOCATOR_DEFAULT_ALIGNMENT);
+}
+
+static void* arena_v2_allocate_aligned(void* context, size_t size, size_t alignment) {
+    return arena_alloc(context, size, alignment);
+}
+
+static void* arena_v2_reallocate(void* context, void* ptr, size_t old_size, size_t new_size) {
+    ArenaAllocator arena = context;
+
+    // 最近一次分配可以原地扩展或收缩
+    if (ptr && ptr == arena->last_alloc) {
+        size_t start = (size_t)((char*)ptr - chunk_data(arena->current));
+        if (start + new_size <= arena->current->capacity) {
+            arena->offset = start + new_size;
+            return ptr;
+        }
+    }
+
+    void* new_ptr = arena_alloc(arena, new_size, ALLOCATOR_DEFAULT_ALIGNMENT);
+    if (ptr && new_ptr) {
+        memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+    }
+    return new_ptr;
+}
+
+static void arena_v2_deallocate(void* context, void* ptr, size_t size, size_t alignment) {
+    ArenaAllocator arena = context;
+
+    // 只有最近一次分配能够回收，其余等待reset
+    if (ptr && ptr == arena->last_alloc) {
+        arena->offset = (size_t)((char*)ptr - chunk_data(arena->current));
+        arena->last_alloc = NULL;
+    }
+    (void)size;
+    (void)alignment;
+}
+
+static const AllocatorVTable arena_vtable = {
+    .allocate = arena_v2_allocate,
+    .allocate_aligned = arena_v2_allocate_aligned,
+    .reallocate = arena_v2_reallocate,
+    .deallocate = arena_v2_deallocate
+};
+
+ArenaAllocator arena_create(size_t chunk_size, Allocator* backing) {
+    if (!backing) backing = get_default_allocator();
+    if (chunk_size == 0) chunk_size = ARENA_DEFAULT_CHUNK_SIZE;
+
+    ArenaAllocator arena = allocator_allocate(backing, sizeof(struct ArenaAllocator));
+    if (!arena) return NULL;
+    arena->allocator = allocator_make(&arena_vtable, arena);
+    arena->backing = backing;
+    arena->chunk_size = chunk_size;
+    arena->offset = 0;
+    arena->used_before = 0;
+    arena->reserved = 0;
+    arena->last_alloc = NULL;
+    arena->first = arena->current = create_chunk(arena, chunk_size);
+    if (!arena->first) {
+        allocator_deallocate(backing, arena, sizeof(struct ArenaAllocator));
+        return NULL;
+    }
+    return arena;
+}
+
+void arena_destroy(ArenaAllocator arena) {
+    ArenaChunk* chunk = arena->first;
+    while (chunk) {
+        ArenaChunk* next = chunk->next;
+        allocator_deallocate(arena->backing, chunk, CHUNK_HEADER_SIZE + chunk->capacity);
+        chunk = next;
+    }
+    allocator_deallocate(arena->backing, arena, sizeof(struct ArenaAllocator));
+}
+
+Allocator* arena_get_allocator(ArenaAllocator arena) {
+    return &arena->allocator;
+}
+
+ArenaMarker arena_save(ArenaAllocator arena) {
+    ArenaMarker marker = { .chunk = arena->current, .offset = arena->offset };
+    return marker;
+}
+
+void arena_restore(ArenaAllocator arena, ArenaMarker marker) {
+    // 重新统计标记之前的块使用量，这些块的used在离开时已经记录
+    size_t used_before = 0;
+    ArenaChunk* chunk = arena->first;
+    while (chunk != marker.chunk) {
+        used_before += chunk->used;
+        chunk = chunk->next;
+    }
+
+    arena->current = marker.chunk;
+    arena->offset = marker.offset;
+    arena->used_before = used_before;
+    arena->last_alloc = NULL;
+}
+
+void arena_reset(ArenaAllocator arena) {
+    arena->current = arena->first;
+    arena->offset = 0;
+    arena->used_before = 0;
+    arena->last_alloc = NULL;
+}
+
+size_t arena_used(const ArenaAllocator arena) {
+    return arena->used_before + arena->offset;
+}
+
+size_t arena_reserved(const ArenaAllocator arena) {
+    return arena->reserved;
+}
+
+// 双缓冲帧分配器
+FrameArena frame_arena_create(size_t chunk_size, Allocator* backing) {
+    if (!backing) backing = get_default_allocator();
+
+    FrameArena frame = allocator_allocate(backing, sizeof(struct FrameArena));
+    if (!frame) return NULL;
+    frame->arenas[0] = arena_create(chunk_size, backing);
+    frame->arenas[1] = arena_create(chunk_size, backing);
+    if (!frame->arenas[0] || !frame->arenas[1]) {
+        if (frame->arenas[0]) arena_destroy(frame->arenas[0]);
+        if (frame->arenas[1]) arena_destroy(frame->arenas[1]);
+        allocator_deallocate(backing, frame, sizeof(struct FrameArena));
+        return NULL;
+    }
+    frame->current = 0;
+    frame->backing = backing;
+    return frame;
+}
+
+void frame_arena_destroy(FrameArena frame) {
+    arena_destroy(frame->arenas[0]);
+    arena_destroy(frame->arenas[1]);
+    allocator_deallocate(frame->backing, frame, sizeof(struct FrameArena));
+}
+
+Allocator* frame_arena_current(FrameArena frame) {
+    return &frame->arenas[frame->current]->allocator;
+}
+
+Allocator* frame_arena_previous(FrameArena frame) {
+    return &frame->arenas[frame->current ^ 1]->allocator;
+}
+
+void frame_arena_swap(FrameArena frame) {
+    frame->current ^= 1;
+    arena_reset(frame->arenas[frame->current]);
+}
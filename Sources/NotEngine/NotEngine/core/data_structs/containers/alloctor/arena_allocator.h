@@ -0,0 +1,59 @@
+﻿#pragma once
+#include "allocator.h"
+
+// 线性（bump）分配器：顺序分配，整体或按标记回退释放
+typedef struct ArenaAllocator* ArenaAllocator;
+
+// 回退标记，记录保存时的分配位置
+typedef struct {
+    void* chunk;
+    size_t offset;
+} ArenaMarker;
+
+// 创建arena，chunk_size为每次向backing申请的块大小（0使用默认值），backing为NULL时使用默认分配器，失败返回NULL
+API ArenaAllocator arena_create(size_t chunk_size, Allocator* backing);
+
+// 销毁arena并归还所有块
+API void arena_destroy(ArenaAllocator arena);
+
+// 获取arena的Allocator接口，可直接传给各容器的create函数
+API Allocator* arena_get_allocator(ArenaAllocator arena);
+
+// 按alignment对齐分配
+API void* arena_alloc(ArenaAllocator arena, size_t size, size_t alignment);
+
+// 保存当前位置
+API ArenaMarker arena_save(ArenaAllocator arena);
+
+// 回退到标记位置，之后分配的内存全部失效
+API void arena_restore(ArenaAllocator arena, ArenaMarker marker);
+
+// O(1)释放全部内存，块保留以供复用
+API void arena_reset(ArenaAllocator arena);
+
+// 已使用的字节数（含对齐填充，不含切换块时各块末尾剩余的空间）
+API size_t arena_used(const ArenaAllocator arena);
+
+// 已向backing申请的总字节数
+API size_t arena_reserved(const ArenaAllocator arena);
+
+// 作用域宏：离开代码块时自动回退（不要在块内break/return）
+#define ARENA_SCOPE(arena) \
+    for (ArenaMarker arena_scope_marker_ = arena_save(arena), *arena_scope_once_ = &arena_scope_marker_; \
+        arena_scope_once_; \
+        arena_restore(arena, arena_scope_marker_), arena_scope_once_ = NULL)
+
+// 双缓冲帧分配器：当前帧写入，上一帧的数据在下一帧内仍然有效
+typedef struct FrameArena* FrameArena;
+
+API FrameArena frame_arena_create(size_t chunk_size, Allocator* backing);
+API void frame_arena_destroy(FrameArena frame);
+
+// 当前帧的分配器
+API Allocator* frame_arena_current(FrameArena frame);
+
+// 上一帧的分配器，只应用于读取上一帧的数据
+API Allocator* frame_arena_previous(FrameArena frame);
+
+// 帧结束时调用：交换两个arena并重置新的当前帧
+API void frame_arena_swap(FrameArena frame);
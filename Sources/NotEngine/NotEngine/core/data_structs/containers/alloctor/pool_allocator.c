@@ -0,0 +1,218 @@
+﻿#include "pool_allocator.h"
+
+#define POOL_DEFAULT_SLAB_BLOCKS 16
+#define POOL_MAX_SLAB_BYTES (256 * 1024)
+
+#define ALIGN_UP(x) (((x) + ALLOCATOR_DEFAULT_ALIGNMENT - 1) & ~(ALLOCATOR_DEFAULT_ALIGNMENT - 1))
+
+// slab头，块紧跟在头之后
+typedef struct PoolSlab {
+    struct PoolSlab* next;
+    size_t block_count;
+} PoolSlab;
+
+#define SLAB_HEADER_SIZE ALIGN_UP(sizeof(PoolSlab))
+
+struct PoolAllocator {
+    Allocator allocator;     // 对外的Allocator接口，context指向自身
+    Allocator* backing;      // 申请slab使用的分配器
+    PoolSlab* slabs;         // 所有slab
+    void* free_list;         // 空闲块链表，块首存放下一个空闲块
+    char* cursor;            // 最新slab中尚未切分区域的起点
+    char* cursor_end;        // 最新slab的末尾
+    size_t block_size;       // 块大小
+    size_t slab_blocks;      // 下一个slab的块数，逐步翻倍
+    size_t used;             // 正在使用的块数
+};
+
+static size_t slab_bytes(const PoolAllocator pool, size_t block_count) {
+    return SLAB_HEADER_SIZE + block_count * pool->block_size;
+}
+
+// 申请新的slab，块按需从cursor切分，不需要预先串成链表
+static bool add_slab(PoolAllocator pool) {
+    PoolSlab* slab = allocator_allocate(pool->backing, slab_bytes(pool, pool->slab_blocks));
+    if (!slab) return false;
+
+    slab->block_count = pool->slab_blocks;
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    pool->cursor = (char*)slab + SLAB_HEADER_SIZE;
+    pool->cursor_end = pool->cursor + slab->block_count * pool->block_size;
+
+    if (slab_bytes(pool, pool->slab_blocks * 2) <= POOL_MAX_SLAB_BYTES) {
+        pool->slab_blocks *= 2;
+    }
+    return true;
+}
+
+void* pool_alloc(PoolAllocator pool) {
+    void* block = pool->free_list;
+    if (block) {
+        pool->free_list = *(void**)block;
+    }
+    else {
+        if (pool->cursor == pool->cursor_end && !add_slab(pool)) return NULL;
+        block = pool->cursor;
+        pool->cursor += pool->block_size;
+    }
+    pool->used++;
+    return block;
+}
+
+void pool_free(PoolAllocator pool, void* block) {
+    if (!block) return;
+    *(void**)block = pool->free_list;
+    pool->free_list = block;
+    pool->used--;
+}
+
+// Allocator接口实现
+static void* pool_v2_allocate(void* context, size_t size) {
+    PoolAllocator pool = context;
+    if (size > pool->block_size) {
+        return allocator_allocate(pool->backing, size);
+    }
+    return pool_alloc(pool);
+}
+
+static void* pool_v2_allocate_aligned(void* context, size_t size, size_t alignment) {
+    PoolAllocator pool = context;
+    if (size > pool->block_size || alignment > ALLOCATOR_DEFAULT_ALIGNMENT) {
+        return allocator_allocate_aligned(pool->backing, size, alignment);
+    }
+    return pool_alloc(pool);
+}
+
+static void* pool_v2_reallocate(void* context, void* ptr, size_t old_size, size_t new_size) {
+    PoolAllocator pool = context;
+    if (old_size > pool->block_size && new_size > pool->block_size) {
+        return allocator_reallocate(pool->backing, ptr, old_size, new_size);
+    }
+    if (ptr && old_size <= pool->block_size && new_size <= pool->block_size) {
+        return ptr;
+    }
+
+    void* new_ptr = pool_v2_allocate(context, new_size);
+    if (ptr && new_ptr) {
+        memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+        if (old_size > pool->block_size) {
+            allocator_deallocate(pool->backing, ptr, old_size);
+        }
+        else {
+            pool_free(pool, ptr);
+        }
+    }
+    return new_ptr;
+}
+
+static void pool_v2_deallocate(void* context, void* ptr, size_t size, size_t alignment) {
+    PoolAllocator pool = context;
+    // 与pool_v2_allocate_aligned的分派条件一致
+    if (size > pool->block_size || alignment > ALLOCATOR_DEFAULT_ALIGNMENT) {
+        allocator_deallocate_aligned(pool->backing, ptr, size, alignment);
+        return;
+    }
+    pool_free(pool, ptr);
+}
+
+static const AllocatorVTable pool_vtable = {
+    .allocate = pool_v2_allocate,
+    .allocate_aligned = pool_v2_allocate_aligned,
+    .reallocate = pool_v2_reallocate,
+    .deallocate = pool_v2_deallocate
+};
+
+PoolAllocator pool_create(size_t block_size, size_t blocks_per_slab, Allocator* backing) {
+    if (!backing) backing = get_default_allocator();
+    if (blocks_per_slab == 0) blocks_per_slab = POOL_DEFAULT_SLAB_BLOCKS;
+    // 空闲块需要容纳一个指针
+    if (block_size < sizeof(void*)) block_size = sizeof(void*);
+
+    PoolAllocator pool = allocator_allocate(backing, sizeof(struct PoolAllocator));
+    pool->allocator = allocator_make(&pool_vtable, pool);
+    pool->backing = backing;
+    pool->slabs = NULL;
+    pool->free_list = NULL;
+    pool->cursor = pool->cursor_end = NULL;
+    pool->block_size = ALIGN_UP(block_size);
+    pool->slab_blocks = blocks_per_slab;
+    pool->used = 0;
+    return pool;
+}
+
+void pool_destroy(PoolAllocator pool) {
+    PoolSlab* slab = pool->slabs;
+    while (slab) {
+        PoolSlab* next = slab->next;
+        allocator_deallocate(pool->backing, slab, slab_bytes(pool, slab->block_count));
+        slab = next;
+    }
+    allocator_deallocate(pool->backing, pool, sizeof(struct PoolAllocator));
+}
+
+void pool_clear(PoolAllocator pool) {
+    pool->free_list = NULL;
+    pool->used = 0;
+    pool->cursor = pool->cursor_end = NULL;
+
+    // 把所有slab的块重新串入空闲链表
+    for (PoolSlab* slab = pool->slabs; slab; slab = slab->next) {
+        char* block = (char*)slab + SLAB_HEADER_SIZE;
+        for (size_t i = 0; i < slab->block_count; i++, block += pool->block_size) {
+            *(void**)block = pool->free_list;
+            pool->free_list = block;
+        }
+    }
+}
+
+bool pool_merge(PoolAllocator dst, PoolAllocator src) {
+    if (dst == src) return true;
+    // slab最终由dst的backing归还，块也要能互相替代
+    if (dst->backing != src->backing || dst->block_size != src->block_size) return false;
+    if (!src->slabs) return true;
+
+    // src未切分的区域直接作为空闲块归还
+    while (src->cursor != src->cursor_end) {
+        *(void**)src->cursor = src->free_list;
+        src->free_list = src->cursor;
+        src->cursor += src->block_size;
+    }
+
+    // 空闲链表拼接到dst
+    if (src->free_list) {
+        void* tail = src->free_list;
+        while (*(void**)tail) {
+            tail = *(void**)tail;
+        }
+        *(void**)tail = dst->free_list;
+        dst->free_list = src->free_list;
+    }
+
+    // slab链表拼接到dst
+    PoolSlab* last = src->slabs;
+    while (last->next) {
+        last = last->next;
+    }
+    last->next = dst->slabs;
+    dst->slabs = src->slabs;
+    dst->used += src->used;
+
+    src->slabs = NULL;
+    src->free_list = NULL;
+    src->cursor = src->cursor_end = NULL;
+    src->used = 0;
+    return true;
+}
+
+Allocator* pool_get_allocator(PoolAllocator pool) {
+    return &pool->allocator;
+}
+
+size_t pool_block_size(const PoolAllocator pool) {
+    return pool->block_size;
+}
+
+size_t pool_used(const PoolAllocator pool) {
+    return pool->used;
+}
@@ -0,0 +1,33 @@
+﻿#pragma once
+#include "allocator.h"
+
+// 定长块池分配器：从大块slab中切分固定大小的块，空闲块串成侵入式链表
+typedef struct PoolAllocator* PoolAllocator;
+
+// 创建池，block_size为块大小，blocks_per_slab为首个slab的块数（0使用默认值），backing为NULL时使用默认分配器
+API PoolAllocator pool_create(size_t block_size, size_t blocks_per_slab, Allocator* backing);
+
+// 销毁池并归还所有slab
+API void pool_destroy(PoolAllocator pool);
+
+// 取出一个块
+API void* pool_alloc(PoolAllocator pool);
+
+// 归还一个块
+API void pool_free(PoolAllocator pool, void* block);
+
+// 归还全部块，slab保留以供复用
+API void pool_clear(PoolAllocator pool);
+
+// 把src的全部slab并入dst，之后src为空；
+// 只有两者的backing和块大小都相同时才能合并，否则不做任何修改并返回false
+API bool pool_merge(PoolAllocator dst, PoolAllocator src);
+
+// 获取池的Allocator接口，超过块大小的请求转交给backing
+API Allocator* pool_get_allocator(PoolAllocator pool);
+
+// 块大小（已按默认对齐取整）
+API size_t pool_block_size(const PoolAllocator pool);
+
+// 正在使用的块数
+API size_t pool_used(const PoolAllocator pool);
@@ -0,0 +1,326 @@
+﻿#include <stdatomic.h>
+#include "thread_cache_allocator.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#define SPAN_SIZE (64 * 1024)
+#define SPAN_HEADER_SIZE 64
+#define CACHE_LINE_SIZE 64
+#define MAX_SMALL_SIZE (16 * 1024)
+#define CLASS_COUNT 34
+#define LARGE_CLASS UINT32_MAX
+
+// 大小分级：128以内步长16，128~512步长64，之后每次翻倍分4级
+// 128以上均为64的倍数，配合64字节的span头，保证64以内的对齐
+static const uint32_t class_sizes[CLASS_COUNT] = {
+    16, 32, 48, 64, 80, 96, 112, 128,
+    192, 256, 320, 384, 448, 512,
+    640, 768, 896, 1024,
+    1280, 1536, 1792, 2048,
+    2560, 3072, 3584, 4096,
+    5120, 6144, 7168, 8192,
+    10240, 12288, 14336, 16384
+};
+
+typedef struct FreeBlock {
+    struct FreeBlock* next;
+} FreeBlock;
+
+struct Heap;
+
+// span头，位于SPAN_SIZE对齐的地址上，任意块地址向下取整即可找到
+typedef struct Span {
+    struct Heap* owner;     // 所属的堆，大块为NULL
+    uint32_t size_class;    // 大小级别，大块为LARGE_CLASS
+    size_t region_size;     // 大块整个区域的字节数
+} Span;
+
+// 线程堆
+typedef struct Heap {
+    _Atomic(FreeBlock*) remote_free;   // 其它线程归还的块，独占一条缓存行
+    char padding[CACHE_LINE_SIZE - sizeof(FreeBlock*)];
+    FreeBlock* free[CLASS_COUNT];      // 各级别的空闲块
+    char* cursor[CLASS_COUNT];         // 各级别当前span中尚未切分的区域
+    char* cursor_end[CLASS_COUNT];
+    struct Heap* next_abandoned;       // 线程退出后挂入待接管链表
+} Heap;
+
+static _Thread_local Heap* tls_heap = NULL;
+
+// 堆的创建与接管很少发生，用自旋锁保护
+static atomic_flag heap_lock = ATOMIC_FLAG_INIT;
+static Heap* abandoned_heaps = NULL;
+static bool thread_exit_hook_ready = false;
+
+#ifdef _WIN32
+static DWORD heap_fls_index;
+#else
+static pthread_key_t heap_key;
+#endif
+
+static void lock_heaps(void) {
+    while (atomic_flag_test_and_set_explicit(&heap_lock, memory_order_acquire)) {
+    }
+}
+
+static void unlock_heaps(void) {
+    atomic_flag_clear_explicit(&heap_lock, memory_order_release);
+}
+
+static Span* span_of(void* ptr) {
+    return (Span*)((uintptr_t)ptr & ~(uintptr_t)(SPAN_SIZE - 1));
+}
+
+static uint32_t floor_log2(size_t value) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return (uint32_t)index;
+#else
+    return 63u - (uint32_t)__builtin_clzll((unsigned long long)value);
+#endif
+}
+
+static uint32_t size_to_class(size_t size) {
+    if (size <= 128) {
+        return size == 0 ? 0 : (uint32_t)((size + 15) / 16 - 1);
+    }
+    if (size <= 512) {
+        return (uint32_t)(7 + (size - 128 + 63) / 64);
+    }
+    uint32_t log = floor_log2(size - 1);
+    size_t base = (size_t)1 << log;
+    size_t step = base / 4;
+    return 14 + (log - 9) * 4 + (uint32_t)((size - base + step - 1) / step) - 1;
+}
+
+// 线程退出时把堆交给待接管链表，其中的空闲块和span由下一个线程继续使用
+static void abandon_heap(void* data) {
+    Heap* heap = data;
+    if (!heap) return;
+    if (tls_heap == heap) tls_heap = NULL;
+
+    lock_heaps();
+    heap->next_abandoned = abandoned_heaps;
+    abandoned_heaps = heap;
+    unlock_heaps();
+}
+
+#ifdef _WIN32
+static void WINAPI heap_fls_callback(void* data) {
+    abandon_heap(data);
+}
+#endif
+
+static Heap* create_heap(void) {
+    lock_heaps();
+
+    if (!thread_exit_hook_ready) {
+#ifdef _WIN32
+        heap_fls_index = FlsAlloc(heap_fls_callback);
+#else
+        pthread_key_create(&heap_key, abandon_heap);
+#endif
+        thread_exit_hook_ready = true;
+    }
+
+    Heap* heap = abandoned_heaps;
+    if (heap) {
+        abandoned_heaps = heap->next_abandoned;
+    }
+    unlock_heaps();
+
+    if (!heap) {
+        heap = allocator_allocate_aligned(get_system_allocator(), sizeof(Heap), CACHE_LINE_SIZE);
+        if (!heap) return NULL;
+        memset(heap, 0, sizeof(Heap));
+        atomic_init(&heap->remote_free, NULL);
+    }
+    heap->next_abandoned = NULL;
+
+#ifdef _WIN32
+    FlsSetValue(heap_fls_index, heap);
+#else
+    pthread_setspecific(heap_key, heap);
+#endif
+    tls_heap = heap;
+    return heap;
+}
+
+static Heap* get_heap(void) {
+    Heap* heap = tls_heap;
+    return heap ? heap : create_heap();
+}
+
+// 把其它线程归还的块放回各级别的空闲链表
+static void collect_remote(Heap* heap) {
+    FreeBlock* block = atomic_exchange_explicit(&heap->remote_free, NULL, memory_order_acquire);
+    while (block) {
+        FreeBlock* next = block->next;
+        uint32_t size_class = span_of(block)->size_class;
+        block->next = heap->free[size_class];
+        heap->free[size_class] = block;
+        block = next;
+    }
+}
+
+static bool heap_add_span(Heap* heap, uint32_t size_class) {
+    Span* span = allocator_allocate_aligned(get_system_allocator(), SPAN_SIZE, SPAN_SIZE);
+    if (!span) return false;
+
+    span->owner = heap;
+    span->size_class = size_class;
+    span->region_size = SPAN_SIZE;
+
+    size_t block_count = (SPAN_SIZE - SPAN_HEADER_SIZE) / class_sizes[size_class];
+    heap->cursor[size_class] = (char*)span + SPAN_HEADER_SIZE;
+    heap->cursor_end[size_class] = heap->cursor[size_class] + block_count * class_sizes[size_class];
+    return true;
+}
+
+static void* heap_alloc(Heap* heap, uint32_t size_class) {
+    FreeBlock* block = heap->free[size_class];
+    if (!block && atomic_load_explicit(&heap->remote_free, memory_order_relaxed)) {
+        collect_remote(heap);
+        block = heap->free[size_class];
+    }
+
+    if (block) {
+        heap->free[size_class] = block->next;
+        return block;
+    }
+
+    // 从当前span切分新块
+    if (heap->cursor[size_class] == heap->cursor_end[size_class] && !heap_add_span(heap, size_class)) {
+        return NULL;
+    }
+    void* ptr = heap->cursor[size_class];
+    heap->cursor[size_class] += class_sizes[size_class];
+    return ptr;
+}
+
+// 大块或大对齐：单独占用一段SPAN_SIZE对齐的区域，头部同样是span头
+static void* large_alloc(size_t size, size_t alignment) {
+    size_t offset = alignment > SPAN_HEADER_SIZE ? alignment : SPAN_HEADER_SIZE;
+    size_t region_size = offset + size;
+
+    Span* span = allocator_allocate_aligned(get_system_allocator(), region_size, SPAN_SIZE);
+    if (!span) return NULL;
+
+    span->owner = NULL;
+    span->size_class = LARGE_CLASS;
+    span->region_size = region_size;
+    return (char*)span + offset;
+}
+
+static void block_free(void* ptr) {
+    Span* span = span_of(ptr);
+    if (span->size_class == LARGE_CLASS) {
+        allocator_deallocate_aligned(get_system_allocator(), span, span->region_size, SPAN_SIZE);
+        return;
+    }
+
+    FreeBlock* block = ptr;
+    Heap* owner = span->owner;
+    if (owner == tls_heap) {
+        block->next = owner->free[span->size_class];
+        owner->free[span->size_class] = block;
+        return;
+    }
+
+    // 跨线程释放：无锁压入所属堆的归还队列
+    FreeBlock* head = atomic_load_explicit(&owner->remote_free, memory_order_relaxed);
+    do {
+        block->next = head;
+    } while (!atomic_compare_exchange_weak_explicit(&owner->remote_free, &head, block,
+        memory_order_release, memory_order_relaxed));
+}
+
+// Allocator接口实现
+static void* tc_allocate(void* context, size_t size) {
+    (void)context;
+    if (size > MAX_SMALL_SIZE) {
+        return large_alloc(size, ALLOCATOR_DEFAULT_ALIGNMENT);
+    }
+    Heap* heap = get_heap();
+    return heap ? heap_alloc(heap, size_to_class(size)) : NULL;
+}
+
+static void* tc_allocate_aligned(void* context, size_t size, size_t alignment) {
+    (void)context;
+    if (alignment > THREAD_CACHE_MAX_ALIGNMENT) {
+        return NULL;
+    }
+    if (alignment > SPAN_HEADER_SIZE || size > MAX_SMALL_SIZE) {
+        return large_alloc(size, alignment);
+    }
+
+    // 64以内的对齐：大小取整到alignment的倍数后，所在级别的块天然对齐
+    if (alignment > ALLOCATOR_DEFAULT_ALIGNMENT) {
+        size = (size + alignment - 1) & ~(alignment - 1);
+    }
+    Heap* heap = get_heap();
+    return heap ? heap_alloc(heap, size_to_class(size)) : NULL;
+}
+
+static void* tc_reallocate(void* context, void* ptr, size_t old_size, size_t new_size) {
+    if (!ptr) return tc_allocate(context, new_size);
+
+    // 新大小仍在原块容量内且不至于浪费过半时原地返回
+    Span* span = span_of(ptr);
+    size_t usable = span->size_class == LARGE_CLASS
+        ? span->region_size - (size_t)((char*)ptr - (char*)span)
+        : class_sizes[span->size_class];
+    if (new_size <= usable && new_size > usable / 2) {
+        return ptr;
+    }
+
+    void* new_ptr = tc_allocate(context, new_size);
+    if (new_ptr) {
+        memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+        block_free(ptr);
+    }
+    return new_ptr;
+}
+
+static void tc_deallocate(void* context, void* ptr, size_t size, size_t alignment) {
+    (void)context;
+    (void)size;
+    (void)alignment;
+    if (ptr) block_free(ptr);
+}
+
+// 旧接口：块头记录了大小级别，释放时不需要大小
+static void* tc_legacy_allocate(size_t size) {
+    return tc_allocate(NULL, size);
+}
+
+static void tc_legacy_deallocate(void* ptr) {
+    if (ptr) block_free(ptr);
+}
+
+static const AllocatorVTable thread_cache_vtable = {
+    .allocate = tc_allocate,
+    .allocate_aligned = tc_allocate_aligned,
+    .reallocate = tc_reallocate,
+    .deallocate = tc_deallocate
+};
+
+static Allocator thread_cache_allocator = {
+    .allocate = tc_legacy_allocate,
+    .deallocate = tc_legacy_deallocate,
+    .vtable = &thread_cache_vtable,
+    .context = NULL
+};
+
+Allocator* thread_cache_allocator_get(void) {
+    return &thread_cache_allocator;
+}
+
+void thread_cache_allocator_collect(void) {
+    Heap* heap = tls_heap;
+    if (heap) collect_remote(heap);
+}
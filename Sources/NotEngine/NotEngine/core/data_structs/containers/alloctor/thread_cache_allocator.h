@@ -0,0 +1,15 @@
+﻿#pragma once
+#include "allocator.h"
+
+// 线程缓存通用分配器
+// 小块按大小分级，每个线程拥有独立的堆，分配和本线程释放不需要任何同步；
+// 其它线程释放的块通过无锁队列归还给所属的堆。线程退出后堆由新线程接管。
+// 对齐上限为THREAD_CACHE_MAX_ALIGNMENT。
+
+#define THREAD_CACHE_MAX_ALIGNMENT (32 * 1024)
+
+// 获取进程唯一的线程缓存分配器，可传给set_default_allocator
+API Allocator* thread_cache_allocator_get(void);
+
+// 立即回收其它线程归还给当前线程的块
+API void thread_cache_allocator_collect(void);
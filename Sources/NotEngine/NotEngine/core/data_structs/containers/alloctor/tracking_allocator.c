@@ -0,0 +1,365 @@
+﻿#include <stdatomic.h>
+#include <stdlib.h>
+#include "tracking_allocator.h"
+#include "core/logger/log.h"
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__GLIBC__) || defined(__APPLE__)
+#include <execinfo.h>
+#define HAS_EXECINFO
+#endif
+
+#define ALIGN_UP(x, a) (((x) + (a) - 1) & ~((a) - 1))
+
+// 调用点模式下每个分配前的记录头，所有存活记录串成双向链表
+typedef struct AllocationRecord {
+    struct AllocationRecord* prev;
+    struct AllocationRecord* next;
+    void* base;           // backing返回的原始地址
+    size_t size;          // 用户请求的大小
+    size_t region_size;   // 向backing申请的大小
+    size_t alignment;     // 向backing申请时的对齐
+    void* frames[TRACKING_CALLSITE_DEPTH];
+} AllocationRecord;
+
+#define RECORD_SIZE ALIGN_UP(sizeof(AllocationRecord), ALLOCATOR_DEFAULT_ALIGNMENT)
+
+struct TrackingAllocator {
+    Allocator allocator;            // 对外的Allocator接口，context指向自身
+    Allocator* backing;
+    char tag[TRACKING_TAG_LENGTH];
+    bool capture_callsites;
+
+    atomic_size_t live_bytes;
+    atomic_size_t peak_bytes;
+    atomic_size_t live_count;
+    atomic_size_t total_allocs;
+    atomic_size_t total_frees;
+    atomic_size_t total_bytes;
+    atomic_size_t histogram[TRACKING_HISTOGRAM_BUCKETS];
+
+    atomic_flag records_lock;       // 保护存活记录链表
+    AllocationRecord* records;
+
+    struct TrackingAllocator* next; // 全局注册链表
+};
+
+// 全局注册表，用于一次性导出所有tag
+static atomic_flag registry_lock = ATOMIC_FLAG_INIT;
+static TrackingAllocator registry = NULL;
+
+static void spin_lock(atomic_flag* flag) {
+    while (atomic_flag_test_and_set_explicit(flag, memory_order_acquire)) {
+    }
+}
+
+static void spin_unlock(atomic_flag* flag) {
+    atomic_flag_clear_explicit(flag, memory_order_release);
+}
+
+static size_t histogram_bucket(size_t size) {
+    size_t bucket = 0;
+    size_t limit = 16;
+    while (size > limit && bucket < TRACKING_HISTOGRAM_BUCKETS - 1) {
+        limit <<= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+static void record_alloc(TrackingAllocator tracker, size_t size) {
+    size_t live = atomic_fetch_add_explicit(&tracker->live_bytes, size, memory_order_relaxed) + size;
+    atomic_fetch_add_explicit(&tracker->live_count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&tracker->total_allocs, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&tracker->total_bytes, size, memory_order_relaxed);
+    atomic_fetch_add_explicit(&tracker->histogram[histogram_bucket(size)], 1, memory_order_relaxed);
+
+    size_t peak = atomic_load_explicit(&tracker->peak_bytes, memory_order_relaxed);
+    while (live > peak && !atomic_compare_exchange_weak_explicit(&tracker->peak_bytes, &peak, live,
+        memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+static void record_free(TrackingAllocator tracker, size_t size) {
+    atomic_fetch_sub_explicit(&tracker->live_bytes, size, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&tracker->live_count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&tracker->total_frees, 1, memory_order_relaxed);
+}
+
+static void capture_frames(void** frames) {
+    memset(frames, 0, sizeof(void*) * TRACKING_CALLSITE_DEPTH);
+    // 跳过capture_frames自身
+#if defined(_WIN32)
+    CaptureStackBackTrace(1, TRACKING_CALLSITE_DEPTH, frames, NULL);
+#elif defined(HAS_EXECINFO)
+    void* buffer[TRACKING_CALLSITE_DEPTH + 1];
+    int count = backtrace(buffer, TRACKING_CALLSITE_DEPTH + 1);
+    for (int i = 1; i < count; i++) {
+        frames[i - 1] = buffer[i];
+    }
+#endif
+}
+
+static AllocationRecord* record_of(void* ptr) {
+    return (AllocationRecord*)((char*)ptr - RECORD_SIZE);
+}
+
+// 调用点模式：在用户内存前放置记录头
+static void* callsite_alloc(TrackingAllocator tracker, size_t size, size_t alignment) {
+    size_t offset = ALIGN_UP(RECORD_SIZE, alignment);
+    size_t region_size = offset + size;
+    char* base = allocator_allocate_aligned(tracker->backing, region_size, alignment);
+    if (!base) return NULL;
+
+    char* ptr = base + offset;
+    AllocationRecord* record = record_of(ptr);
+    record->base = base;
+    record->size = size;
+    record->region_size = region_size;
+    record->alignment = alignment;
+    capture_frames(record->frames);
+
+    spin_lock(&tracker->records_lock);
+    record->prev = NULL;
+    record->next = tracker->records;
+    if (tracker->records) tracker->records->prev = record;
+    tracker->records = record;
+    spin_unlock(&tracker->records_lock);
+    return ptr;
+}
+
+static void callsite_free(TrackingAllocator tracker, void* ptr) {
+    AllocationRecord* record = record_of(ptr);
+
+    spin_lock(&tracker->records_lock);
+    if (record->prev) record->prev->next = record->next;
+    else tracker->records = record->next;
+    if (record->next) record->next->prev = record->prev;
+    spin_unlock(&tracker->records_lock);
+
+    allocator_deallocate_aligned(tracker->backing, record->base, record->region_size, record->alignment);
+}
+
+// Allocator接口实现
+static void* tracking_v2_allocate_aligned(void* context, size_t size, size_t alignment) {
+    TrackingAllocator tracker = context;
+    if (alignment < ALLOCATOR_DEFAULT_ALIGNMENT) alignment = ALLOCATOR_DEFAULT_ALIGNMENT;
+
+    void* ptr = tracker->capture_callsites
+        ? callsite_alloc(tracker, size, alignment)
+        : allocator_allocate_aligned(tracker->backing, size, alignment);
+    if (ptr) record_alloc(tracker, size);
+    return ptr;
+}
+
+static void* tracking_v2_allocate(void* context, size_t size) {
+    TrackingAllocator tracker = context;
+    if (tracker->capture_callsites) {
+        return tracking_v2_allocate_aligned(context, size, ALLOCATOR_DEFAULT_ALIGNMENT);
+    }
+
+    void* ptr = allocator_allocate(tracker->backing, size);
+    if (ptr) record_alloc(tracker, size);
+    return ptr;
+}
+
+static void tracking_v2_deallocate(void* context, void* ptr, size_t size, size_t alignment) {
+    TrackingAllocator tracker = context;
+    if (!ptr) return;
+
+    if (tracker->capture_callsites) {
+        size = record_of(ptr)->size;
+        callsite_free(tracker, ptr);
+    }
+    else {
+        // 与分配时一样按对齐释放，backing为旧接口时对齐分配带有额外的头部
+        allocator_deallocate_aligned(tracker->backing, ptr, size, alignment);
+    }
+    record_free(tracker, size);
+}
+
+static void* tracking_v2_reallocate(void* context, void* ptr, size_t old_size, size_t new_size) {
+    TrackingAllocator tracker = context;
+
+    if (tracker->capture_callsites) {
+        void* new_ptr = tracking_v2_allocate(context, new_size);
+        if (ptr && new_ptr) {
+            memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+            tracking_v2_deallocate(context, ptr, old_size, ALLOCATOR_DEFAULT_ALIGNMENT);
+        }
+        return new_ptr;
+    }
+
+    void* new_ptr = allocator_reallocate(tracker->backing, ptr, old_size, new_size);
+    if (new_ptr) {
+        if (ptr) record_free(tracker, old_size);
+        record_alloc(tracker, new_size);
+    }
+    return new_ptr;
+}
+
+static const AllocatorVTable tracking_vtable = {
+    .allocate = tracking_v2_allocate,
+    .allocate_aligned = tracking_v2_allocate_aligned,
+    .reallocate = tracking_v2_reallocate,
+    .deallocate = tracking_v2_deallocate
+};
+
+TrackingAllocator tracking_allocator_create(const char* tag, Allocator* backing, bool capture_callsites) {
+    if (!backing) backing = get_default_allocator();
+
+    TrackingAllocator tracker = allocator_allocate(backing, sizeof(struct TrackingAllocator));
+    tracker->allocator = allocator_make(&tracking_vtable, tracker);
+    tracker->backing = backing;
+    snprintf(tracker->tag, sizeof(tracker->tag), "%s", tag ? tag : "untagged");
+    tracker->capture_callsites = capture_callsites;
+
+    atomic_init(&tracker->live_bytes, 0);
+    atomic_init(&tracker->peak_bytes, 0);
+    atomic_init(&tracker->live_count, 0);
+    atomic_init(&tracker->total_allocs, 0);
+    atomic_init(&tracker->total_frees, 0);
+    atomic_init(&tracker->total_bytes, 0);
+    for (size_t i = 0; i < TRACKING_HISTOGRAM_BUCKETS; i++) {
+        atomic_init(&tracker->histogram[i], 0);
+    }
+    atomic_flag_clear(&tracker->records_lock);
+    tracker->records = NULL;
+
+    spin_lock(&registry_lock);
+    tracker->next = registry;
+    registry = tracker;
+    spin_unlock(&registry_lock);
+    return tracker;
+}
+
+void tracking_allocator_destroy(TrackingAllocator tracker) {
+    spin_lock(&registry_lock);
+    TrackingAllocator* curr = &registry;
+    while (*curr && *curr != tracker) {
+        curr = &(*curr)->next;
+    }
+    if (*curr) *curr = tracker->next;
+    spin_unlock(&registry_lock);
+
+    size_t live_count = atomic_load(&tracker->live_count);
+    if (live_count > 0) {
+        LOG_WARN("Memory leak in '%s': %zu allocations, %zu bytes still live",
+            tracker->tag, live_count, atomic_load(&tracker->live_bytes));
+    }
+    allocator_deallocate(tracker->backing, tracker, sizeof(struct TrackingAllocator));
+}
+
+Allocator* tracking_allocator_get(TrackingAllocator tracker) {
+    return &tracker->allocator;
+}
+
+MemoryStats tracking_allocator_stats(const TrackingAllocator tracker) {
+    MemoryStats stats;
+    memcpy(stats.tag, tracker->tag, sizeof(stats.tag));
+    stats.live_bytes = atomic_load_explicit(&tracker->live_bytes, memory_order_relaxed);
+    stats.peak_bytes = atomic_load_explicit(&tracker->peak_bytes, memory_order_relaxed);
+    stats.live_count = atomic_load_explicit(&tracker->live_count, memory_order_relaxed);
+    stats.total_allocs = atomic_load_explicit(&tracker->total_allocs, memory_order_relaxed);
+    stats.total_frees = atomic_load_explicit(&tracker->total_frees, memory_order_relaxed);
+    stats.total_bytes = atomic_load_explicit(&tracker->total_bytes, memory_order_relaxed);
+    for (size_t i = 0; i < TRACKING_HISTOGRAM_BUCKETS; i++) {
+        stats.histogram[i] = atomic_load_explicit(&tracker->histogram[i], memory_order_relaxed);
+    }
+    return stats;
+}
+
+static int compare_records(const void* a, const void* b) {
+    const AllocationRecord* ra = *(const AllocationRecord* const*)a;
+    const AllocationRecord* rb = *(const AllocationRecord* const*)b;
+    return memcmp(ra->frames, rb->frames, sizeof(ra->frames));
+}
+
+// 按调用栈汇总存活的分配
+static void dump_callsites(TrackingAllocator tracker, FILE* file) {
+    spin_lock(&tracker->records_lock);
+
+    size_t count = 0;
+    for (AllocationRecord* r = tracker->records; r; r = r->next) count++;
+
+    AllocationRecord** sorted = count ? malloc(count * sizeof(AllocationRecord*)) : NULL;
+    if (sorted) {
+        size_t i = 0;
+        for (AllocationRecord* r = tracker->records; r; r = r->next) sorted[i++] = r;
+        qsort(sorted, count, sizeof(AllocationRecord*), compare_records);
+
+        fprintf(file, "  live allocations by callsite:\n");
+        for (size_t begin = 0; begin < count;) {
+            size_t end = begin;
+            size_t bytes = 0;
+            while (end < count && compare_records(&sorted[begin], &sorted[end]) == 0) {
+                bytes += sorted[end]->size;
+                end++;
+            }
+
+            fprintf(file, "    %zu allocations, %zu bytes at", end - begin, bytes);
+            for (size_t f = 0; f < TRACKING_CALLSITE_DEPTH && sorted[begin]->frames[f]; f++) {
+                fprintf(file, " %p", sorted[begin]->frames[f]);
+            }
+            fprintf(file, "\n");
+            begin = end;
+        }
+        free(sorted);
+    }
+
+    spin_unlock(&tracker->records_lock);
+}
+
+void tracking_allocator_dump(const TrackingAllocator tracker, FILE* file) {
+    MemoryStats stats = tracking_allocator_stats(tracker);
+    fprintf(file, "[%s] live %zu bytes in %zu allocations, peak %zu bytes, "
+        "%zu allocs / %zu frees, %zu bytes allocated in total\n",
+        stats.tag, stats.live_bytes, stats.live_count, stats.peak_bytes,
+        stats.total_allocs, stats.total_frees, stats.total_bytes);
+
+    fprintf(file, "  size histogram:");
+    for (size_t i = 0; i < TRACKING_HISTOGRAM_BUCKETS; i++) {
+        if (stats.histogram[i] == 0) continue;
+        if (i == TRACKING_HISTOGRAM_BUCKETS - 1) {
+            fprintf(file, " >%zu:%zu", (size_t)16 << (i - 1), stats.histogram[i]);
+        }
+        else {
+            fprintf(file, " <=%zu:%zu", (size_t)16 << i, stats.histogram[i]);
+        }
+    }
+    fprintf(file, "\n");
+
+    if (tracker->capture_callsites) {
+        dump_callsites(tracker, file);
+    }
+}
+
+size_t memory_tracking_collect(MemoryStats* out, size_t max_count) {
+    size_t count = 0;
+    spin_lock(&registry_lock);
+    for (TrackingAllocator tracker = registry; tracker; tracker = tracker->next) {
+        if (out && count < max_count) {
+            out[count] = tracking_allocator_stats(tracker);
+        }
+        count++;
+    }
+    spin_unlock(&registry_lock);
+    return count;
+}
+
+bool memory_tracking_dump(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        LOG_ERROR("Failed to open memory stats file: %s", path);
+        return false;
+    }
+
+    spin_lock(&registry_lock);
+    for (TrackingAllocator tracker = registry; tracker; tracker = tracker->next) {
+        tracking_allocator_dump(tracker, file);
+    }
+    spin_unlock(&registry_lock);
+
+    fclose(file);
+    return true;
+}
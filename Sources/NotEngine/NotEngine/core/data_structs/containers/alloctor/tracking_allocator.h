@@ -0,0 +1,46 @@
+﻿#pragma once
+#include <stdio.h>
+#include "allocator.h"
+
+// 统计型分配器包装：按名称（tag）统计经过它的所有分配，用它创建的容器自动计入该tag
+
+#define TRACKING_TAG_LENGTH 32
+// 直方图第i格统计大小在(16<<(i-1), 16<<i]的分配，最后一格包含所有更大的分配
+#define TRACKING_HISTOGRAM_BUCKETS 16
+// 调用点模式下记录的调用栈深度
+#define TRACKING_CALLSITE_DEPTH 6
+
+typedef struct TrackingAllocator* TrackingAllocator;
+
+typedef struct {
+    char tag[TRACKING_TAG_LENGTH];
+    size_t live_bytes;      // 当前占用字节数
+    size_t peak_bytes;      // 峰值占用字节数
+    size_t live_count;      // 当前存活的分配数
+    size_t total_allocs;    // 累计分配次数
+    size_t total_frees;     // 累计释放次数
+    size_t total_bytes;     // 累计分配字节数
+    size_t histogram[TRACKING_HISTOGRAM_BUCKETS];
+} MemoryStats;
+
+// 创建统计分配器，backing为NULL时使用默认分配器
+// capture_callsites为true时为每个分配记录调用栈（每个分配额外占用一个记录头）
+API TrackingAllocator tracking_allocator_create(const char* tag, Allocator* backing, bool capture_callsites);
+
+// 销毁统计分配器，仍有未释放的分配时输出警告
+API void tracking_allocator_destroy(TrackingAllocator tracker);
+
+// 获取Allocator接口，可直接传给各容器的create函数
+API Allocator* tracking_allocator_get(TrackingAllocator tracker);
+
+// 获取当前统计数据
+API MemoryStats tracking_allocator_stats(const TrackingAllocator tracker);
+
+// 输出统计数据；调用点模式下按调用栈汇总存活的分配
+API void tracking_allocator_dump(const TrackingAllocator tracker, FILE* file);
+
+// 获取所有存活的统计分配器的数据，返回总数（可能大于max_count）
+API size_t memory_tracking_collect(MemoryStats* out, size_t max_count);
+
+// 把所有统计分配器的数据写入文件
+API bool memory_tracking_dump(const char* path);
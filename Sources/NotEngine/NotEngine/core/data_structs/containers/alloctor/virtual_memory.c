@@ -0,0 +1,134 @@
+﻿// 以C17编译时系统头文件默认不声明MAP_ANONYMOUS、MAP_NORESERVE和madvise，须在包含任何头文件之前开启
+#define _DEFAULT_SOURCE
+#include "virtual_memory.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+size_t vm_page_size(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+#else
+    return (size_t)sysconf(_SC_PAGESIZE);
+#endif
+}
+
+void* vm_reserve(size_t size, size_t alignment) {
+#ifdef _WIN32
+    // 预留地址天然按64KB分配粒度对齐；Windows大页需要特权且必须一次性提交，这里不做更大的对齐
+    (void)alignment;
+    return VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_NOACCESS);
+#else
+    if (alignment <= vm_page_size()) {
+        void* addr = mmap(NULL, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        return addr == MAP_FAILED ? NULL : addr;
+    }
+
+    // 多预留alignment字节，再裁掉首尾多余部分
+    size_t padded = size + alignment;
+    char* raw = mmap(NULL, padded, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (raw == MAP_FAILED) return NULL;
+
+    char* aligned = (char*)(((uintptr_t)raw + alignment - 1) & ~(uintptr_t)(alignment - 1));
+    if (aligned > raw) {
+        munmap(raw, (size_t)(aligned - raw));
+    }
+    size_t tail = (size_t)((raw + padded) - (aligned + size));
+    if (tail > 0) {
+        munmap(aligned + size, tail);
+    }
+    return aligned;
+#endif
+}
+
+bool vm_commit(void* addr, size_t size) {
+#ifdef _WIN32
+    return VirtualAlloc(addr, size, MEM_COMMIT, PAGE_READWRITE) != NULL;
+#else
+    return mprotect(addr, size, PROT_READ | PROT_WRITE) == 0;
+#endif
+}
+
+void vm_decommit(void* addr, size_t size) {
+#ifdef _WIN32
+    VirtualFree(addr, size, MEM_DECOMMIT);
+#else
+    madvise(addr, size, MADV_DONTNEED);
+    mprotect(addr, size, PROT_NONE);
+#endif
+}
+
+void vm_release(void* addr, size_t size) {
+#ifdef _WIN32
+    (void)size;
+    VirtualFree(addr, 0, MEM_RELEASE);
+#else
+    munmap(addr, size);
+#endif
+}
+
+void vm_advise_huge_pages(void* addr, size_t size) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    madvise(addr, size, MADV_HUGEPAGE);
+#else
+    (void)addr;
+    (void)size;
+#endif
+}
+
+const void* vm_map_file(const char* path, size_t* size) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return NULL;
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+        CloseHandle(file);
+        return NULL;
+    }
+
+    // 视图建立后映射对象和文件句柄都可以关闭，视图仍然有效
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!mapping) return NULL;
+
+    void* addr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!addr) return NULL;
+
+    *size = (size_t)file_size.QuadPart;
+    return addr;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return NULL;
+    }
+
+    void* addr = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) return NULL;
+
+    *size = (size_t)info.st_size;
+    return addr;
+#endif
+}
+
+void vm_unmap_file(const void* addr, size_t size) {
+#ifdef _WIN32
+    (void)size;
+    UnmapViewOfFile(addr);
+#else
+    munmap((void*)addr, size);
+#endif
+}
@@ -0,0 +1,29 @@
+﻿#pragma once
+#include "allocator.h"
+
+// 透明大页大小
+#define VM_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+// 系统页大小
+API size_t vm_page_size(void);
+
+// 预留一段不可访问的地址空间，alignment为0或页大小的整数倍，失败返回NULL
+API void* vm_reserve(size_t size, size_t alignment);
+
+// 提交预留区间中的页，之后可读写
+API bool vm_commit(void* addr, size_t size);
+
+// 归还已提交的页，地址仍保持预留
+API void vm_decommit(void* addr, size_t size);
+
+// 释放整个预留区间，size须与vm_reserve时一致
+API void vm_release(void* addr, size_t size);
+
+// 建议系统用透明大页支撑该区间（不支持的平台上无效果）
+API void vm_advise_huge_pages(void* addr, size_t size);
+
+// 以只读方式把整个文件映射到内存，size返回文件大小；失败或文件为空时返回NULL
+API const void* vm_map_file(const char* path, size_t* size);
+
+// 解除vm_map_file建立的映射
+API void vm_unmap_file(const void* addr, size_t size);
@@ -1,5 +1,7 @@
 ﻿#include <string.h>
 #include "array_list.h"
+#include "alloctor/virtual_memory.h"
+#include "core/logger/log.h"
 #define INITIAL_CAPACITY 4
 #define GROW_FACTOR 2
 
@@ -10,22 +12,69 @@ struct ArrayList
     size_t size; // 当前元素个数
     size_t capacity; // 当前容量
     Allocator* allocator; // 内存分配器
+    size_t reserved_bytes; // 虚拟内存模式下预留的字节数，0表示普通模式
+    size_t committed_bytes; // 虚拟内存模式下已提交的字节数
+    size_t commit_granularity; // 虚拟内存模式下提交/归还的粒度
 };
 
-static void expand_capacity(ArrayList list)
+// 虚拟内存模式：在预留区间内提交更多页，数据原地不动
+static void commit_capacity(ArrayList list, size_t min_capacity)
 {
-    int new_capacity = list->capacity * GROW_FACTOR;
-    void* new_data = list->allocator->allocate(new_capacity * list->element_size);
-    // 复制旧数据到新内存
-    memcpy(new_data, list->data, list->size * list->element_size);
+    size_t needed = min_capacity * list->element_size;
+    size_t new_committed = list->committed_bytes;
+    while (new_committed < needed && new_committed < list->reserved_bytes)
+    {
+        new_committed *= GROW_FACTOR;
+    }
+    if (new_committed > list->reserved_bytes)
+    {
+        new_committed = list->reserved_bytes;
+    }
+    if (new_committed < needed ||
+        !vm_commit((char*)list->data + list->committed_bytes, new_committed - list->committed_bytes))
+    {
+        LOG_FATAL("ArrayList reserved range exhausted (%zu bytes)", list->reserved_bytes);
+        return;
+    }
 
-    // 释放旧内存
-    list->allocator->deallocate(list->data);
+    list->committed_bytes = new_committed;
+    list->capacity = new_committed / list->element_size;
+}
 
-    list->data = new_data;
+// 把容量精确设置为new_capacity，优先使用分配器的realloc，避免额外的复制
+static void set_capacity(ArrayList list, size_t new_capacity)
+{
+    list->data = allocator_reallocate(list->allocator, list->data,
+        list->capacity * list->element_size, new_capacity * list->element_size);
     list->capacity = new_capacity;
 }
 
+// 保证容量不小于min_capacity，按GROW_FACTOR倍增以保证均摊O(1)
+static void grow_to(ArrayList list, size_t min_capacity)
+{
+    if (min_capacity <= list->capacity)
+    {
+        return;
+    }
+    if (list->reserved_bytes)
+    {
+        commit_capacity(list, min_capacity);
+        return;
+    }
+
+    size_t new_capacity = list->capacity * GROW_FACTOR;
+    if (new_capacity < min_capacity)
+    {
+        new_capacity = min_capacity;
+    }
+    set_capacity(list, new_capacity);
+}
+
+static void expand_capacity(ArrayList list)
+{
+    grow_to(list, list->size + 1);
+}
+
 ArrayList arraylist_create(size_t element_size, Allocator* allocator)
 {
     if (allocator == NULL)
@@ -33,21 +82,77 @@ ArrayList arraylist_create(size_t element_size, Allocator* allocator)
         allocator = get_default_allocator();
     }
 
-    ArrayList list = allocator->allocate(sizeof(ArrayList));
-    list->data = allocator->allocate(INITIAL_CAPACITY * element_size);
+    ArrayList list = allocator_allocate(allocator, sizeof(struct ArrayList));
+    list->data = allocator_allocate(allocator, INITIAL_CAPACITY * element_size);
 
     list->element_size = element_size;
     list->size = 0;
     list->capacity = INITIAL_CAPACITY;
     list->allocator = allocator;
+    list->reserved_bytes = 0;
+    list->committed_bytes = 0;
+    list->commit_granularity = 0;
+    return list;
+}
+
+ArrayList arraylist_create_virtual(size_t element_size, size_t max_elements, bool huge_pages, Allocator* allocator)
+{
+    if (allocator == NULL)
+    {
+        allocator = get_default_allocator();
+    }
+    size_t granularity = huge_pages ? VM_HUGE_PAGE_SIZE : vm_page_size();
+    // 预留0字节没有意义，也不能悄悄退化为普通列表；按页取整后也不能溢出
+    if (element_size == 0 || max_elements == 0 || max_elements > (SIZE_MAX - granularity) / element_size)
+    {
+        LOG_ERROR("Invalid virtual ArrayList size: %zu elements of %zu bytes", max_elements, element_size);
+        return NULL;
+    }
+
+    size_t reserved = (max_elements * element_size + granularity - 1) / granularity * granularity;
+    size_t committed = (INITIAL_CAPACITY * element_size + granularity - 1) / granularity * granularity;
+    if (committed > reserved) committed = reserved;
+
+    void* data = vm_reserve(reserved, huge_pages ? VM_HUGE_PAGE_SIZE : 0);
+    if (!data || !vm_commit(data, committed))
+    {
+        LOG_ERROR("Failed to reserve %zu bytes for ArrayList", reserved);
+        if (data) vm_release(data, reserved);
+        return NULL;
+    }
+    if (huge_pages)
+    {
+        vm_advise_huge_pages(data, reserved);
+    }
+
+    ArrayList list = allocator_allocate(allocator, sizeof(struct ArrayList));
+    if (!list)
+    {
+        vm_release(data, reserved);
+        return NULL;
+    }
+    list->data = data;
+    list->element_size = element_size;
+    list->size = 0;
+    list->capacity = committed / element_size;
+    list->allocator = allocator;
+    list->reserved_bytes = reserved;
+    list->committed_bytes = committed;
+    list->commit_granularity = granularity;
     return list;
 }
 
 void arraylist_destroy(ArrayList list)
 {
-    list->allocator->deallocate(list->data);
-    list->allocator->deallocate(list);
-    list->data = NULL;
+    if (list->reserved_bytes)
+    {
+        vm_release(list->data, list->reserved_bytes);
+    }
+    else
+    {
+        allocator_deallocate(list->allocator, list->data, list->capacity * list->element_size);
+    }
+    allocator_deallocate(list->allocator, list, sizeof(struct ArrayList));
 }
 
 void arraylist_push_back(ArrayList list, const void* element)
@@ -65,13 +170,14 @@ void arraylist_push_back(ArrayList list, const void* element)
 
 void arraylist_pop_back(ArrayList list, void* dest)
 {
-    if (dest)
+    if (list->size == 0)
     {
-        arraylist_get(list, list->size, dest);
+        return;
     }
-    if (list->size > 0)
+    list->size--;
+    if (dest)
     {
-        list->size--;
+        arraylist_get(list, (int)list->size, dest);
     }
 }
 
@@ -80,6 +186,21 @@ void arraylist_get(const ArrayList list, int index, void* dest)
     memcpy(dest, (char*)list->data + index * list->element_size, list->element_size);
 }
 
+void* arraylist_at(ArrayList list, int index)
+{
+    return (char*)list->data + index * list->element_size;
+}
+
+void* arraylist_data(ArrayList list)
+{
+    return list->data;
+}
+
+Span arraylist_span(ArrayList list)
+{
+    return span_make(list->data, list->size, list->element_size);
+}
+
 void arraylist_set(ArrayList list, int index, const void* element)
 {
     void* dest = (char*)list->data + index * list->element_size;
@@ -115,6 +236,136 @@ void arraylist_erase(ArrayList list, int index)
     list->size--;
 }
 
+void arraylist_reserve(ArrayList list, size_t capacity)
+{
+    if (capacity <= list->capacity)
+    {
+        return;
+    }
+    if (list->reserved_bytes)
+    {
+        commit_capacity(list, capacity);
+        return;
+    }
+    set_capacity(list, capacity);
+}
+
+void arraylist_resize(ArrayList list, size_t size, const void* fill)
+{
+    if (size > list->size)
+    {
+        grow_to(list, size);
+        char* dest = (char*)list->data + list->size * list->element_size;
+        if (fill)
+        {
+            for (size_t i = list->size; i < size; i++, dest += list->element_size)
+            {
+                memcpy(dest, fill, list->element_size);
+            }
+        }
+        else
+        {
+            memset(dest, 0, (size - list->size) * list->element_size);
+        }
+    }
+    list->size = size;
+}
+
+void arraylist_shrink_to_fit(ArrayList list)
+{
+    if (list->reserved_bytes)
+    {
+        // 归还多余的页，预留区间保持不变
+        size_t granularity = list->commit_granularity;
+        size_t keep = (list->size * list->element_size + granularity - 1) / granularity * granularity;
+        if (keep == 0)
+        {
+            keep = granularity;
+        }
+        if (keep < list->committed_bytes)
+        {
+            vm_decommit((char*)list->data + keep, list->committed_bytes - keep);
+            list->committed_bytes = keep;
+            list->capacity = keep / list->element_size;
+        }
+        return;
+    }
+
+    size_t new_capacity = list->size > 0 ? list->size : 1;
+    if (new_capacity < list->capacity)
+    {
+        set_capacity(list, new_capacity);
+    }
+}
+
+// elements是否指向列表现有的元素；扩容会使其失效，需要先记下偏移
+static bool points_into(const ArrayList list, const void* elements)
+{
+    uintptr_t begin = (uintptr_t)list->data;
+    uintptr_t p = (uintptr_t)elements;
+    return p >= begin && p < begin + list->size * list->element_size;
+}
+
+void arraylist_push_back_n(ArrayList list, const void* elements, size_t count)
+{
+    if (count == 0) return;
+
+    bool aliased = points_into(list, elements);
+    size_t offset = aliased ? (size_t)((const char*)elements - (char*)list->data) : 0;
+    grow_to(list, list->size + count);
+    if (aliased) elements = (char*)list->data + offset;
+
+    memcpy((char*)list->data + list->size * list->element_size, elements, count * list->element_size);
+    list->size += count;
+}
+
+void arraylist_insert_range(ArrayList list, int index, const void* elements, size_t count)
+{
+    if (count == 0) return;
+
+    bool aliased = points_into(list, elements);
+    size_t offset = aliased ? (size_t)((const char*)elements - (char*)list->data) : 0;
+    grow_to(list, list->size + count);
+
+    // 尾部整体后移一次
+    size_t bytes = count * list->element_size;
+    size_t pos = index * list->element_size;
+    char* dest = (char*)list->data + pos;
+    memmove(dest + bytes, dest, (list->size - index) * list->element_size);
+
+    if (!aliased)
+    {
+        memcpy(dest, elements, bytes);
+    }
+    else
+    {
+        // 源区间在pos之前的部分没有移动，pos及之后的部分随尾部后移了bytes
+        size_t before = offset < pos ? pos - offset : 0;
+        if (before > bytes) before = bytes;
+        memcpy(dest, (char*)list->data + offset, before);
+        memcpy(dest + before, (char*)list->data + offset + before + bytes, bytes - before);
+    }
+    list->size += count;
+}
+
+void arraylist_erase_range(ArrayList list, int index, size_t count)
+{
+    // 尾部整体前移一次
+    char* dest = (char*)list->data + index * list->element_size;
+    size_t tail = list->size - index - count;
+    memmove(dest, dest + count * list->element_size, tail * list->element_size);
+    list->size -= count;
+}
+
+void arraylist_append_list(ArrayList list, const ArrayList other)
+{
+    // list与other可以是同一个列表
+    size_t count = other->size;
+    grow_to(list, list->size + count);
+    memcpy((char*)list->data + list->size * list->element_size, other->data, count * list->element_size);
+    list->size += count;
+}
+
 size_t arraylist_size(const ArrayList list)
 {
     return list->size;
@@ -177,7 +428,11 @@ Iterator arraylist_end(ArrayList list)
     Iterator it = {
         .ptr = (char*)list->data + list->size * list->element_size,
         .container = list,
-        .elem_size = list->element_size
+        .elem_size = list->element_size,
+        .next = array_iterator_next,
+        .prev = array_iterator_prev,
+        .get = array_iterator_get,
+        .set = array_iterator_set
     };
     return it;
 }
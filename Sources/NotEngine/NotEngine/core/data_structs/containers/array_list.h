@@ -1,13 +1,19 @@
 ﻿#pragma once
 #include "typedefs.h"
-#include "core/data_structs/iterator/iterator.h"
-#include "core/data_structs/alloctor/allocator.h"
+#include "iterator/iterator.h"
+#include "alloctor/allocator.h"
+#include "span.h"
 
 typedef struct ArrayList* ArrayList;
 
 // 创建新的ArrayList，可选指定分配器（NULL表示使用默认分配器）
 API ArrayList arraylist_create(size_t element_size, Allocator* allocator);
 
+// 创建基于虚拟内存的ArrayList：一次预留max_elements个元素的地址空间，增长时只提交新页，
+// 从不复制，元素地址始终不变；huge_pages为true时请求透明大页（仅Linux）
+// allocator只用于分配列表对象本身（NULL表示使用默认分配器）；max_elements为0或预留失败时返回NULL
+API ArrayList arraylist_create_virtual(size_t element_size, size_t max_elements, bool huge_pages, Allocator* allocator);
+
 // 销毁ArrayList
 API void arraylist_destroy(ArrayList list);
 
@@ -20,6 +26,15 @@ API void arraylist_pop_back(ArrayList list,void* dest);
 // 获取指定位置的元素
 API void arraylist_get(const ArrayList list, int index,void* dest);
 
+// 获取指定位置元素的地址，不复制；扩容后地址失效
+API void* arraylist_at(ArrayList list, int index);
+
+// 获取底层连续存储的首地址
+API void* arraylist_data(ArrayList list);
+
+// 获取覆盖全部元素的Span视图，扩容后失效
+API Span arraylist_span(ArrayList list);
+
 // 设置指定位置的元素
 API void arraylist_set(ArrayList list, int index, const void* element);
 
@@ -29,6 +44,27 @@ API void arraylist_insert(ArrayList list, int index, const void* element);
 // 删除指定位置的元素
 API void arraylist_erase(ArrayList list, int index);
 
+// 预留至少capacity个元素的容量
+API void arraylist_reserve(ArrayList list, size_t capacity);
+
+// 调整元素个数，新增元素用fill填充（NULL表示清零）
+API void arraylist_resize(ArrayList list, size_t size, const void* fill);
+
+// 释放多余的容量
+API void arraylist_shrink_to_fit(ArrayList list);
+
+// 在末尾批量添加count个连续存放的元素，只扩容和复制一次；elements可以指向列表自身的元素
+API void arraylist_push_back_n(ArrayList list, const void* elements, size_t count);
+
+// 在指定位置批量插入count个元素，尾部只移动一次；elements可以指向列表自身的元素
+API void arraylist_insert_range(ArrayList list, int index, const void* elements, size_t count);
+
+// 删除[index, index + count)的元素，尾部只移动一次
+API void arraylist_erase_range(ArrayList list, int index, size_t count);
+
+// 把other的全部元素追加到末尾
+API void arraylist_append_list(ArrayList list, const ArrayList other);
+
 // 获取当前大小
 API size_t arraylist_size(const ArrayList list);
 
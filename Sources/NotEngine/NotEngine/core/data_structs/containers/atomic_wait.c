@@ -0,0 +1,98 @@
+﻿// 以C17编译时系统头文件默认不声明syscall，须在包含任何头文件之前开启
+#define _DEFAULT_SOURCE
+#include "atomic_wait.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#pragma comment(lib, "Synchronization.lib")
+#elif defined(__linux__)
+#include <linux/futex.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <sched.h>
+#endif
+
+// 休眠或让出CPU之前的自旋次数
+#define SPIN_COUNT 256
+
+void atomic_wait_u32(atomic_uint* address, uint32_t expected) {
+#if defined(_WIN32)
+    WaitOnAddress((volatile VOID*)address, &expected, sizeof(uint32_t), INFINITE);
+#elif defined(__linux__)
+    syscall(SYS_futex, (uint32_t*)address, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+#else
+    if (atomic_load_explicit(address, memory_order_relaxed) == expected) {
+        sched_yield();
+    }
+#endif
+}
+
+void atomic_wake_one(atomic_uint* address) {
+#if defined(_WIN32)
+    WakeByAddressSingle((PVOID)address);
+#elif defined(__linux__)
+    syscall(SYS_futex, (uint32_t*)address, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+#else
+    (void)address;
+#endif
+}
+
+void atomic_wake_all(atomic_uint* address) {
+#if defined(_WIN32)
+    WakeByAddressAll((PVOID)address);
+#elif defined(__linux__)
+    syscall(SYS_futex, (uint32_t*)address, FUTEX_WAKE_PRIVATE, INT32_MAX, NULL, NULL, 0);
+#else
+    (void)address;
+#endif
+}
+
+void thread_yield(void) {
+#ifdef _WIN32
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+void wait_event_init(WaitEvent* event) {
+    atomic_init(&event->waiters, 0);
+    atomic_init(&event->epoch, 0);
+}
+
+void wait_event_wait(WaitEvent* event, WaitStrategy strategy, WaitCondition ready, void* context) {
+    for (uint32_t spin = 0; !ready(context); spin++) {
+        if (spin < SPIN_COUNT) {
+            cpu_relax();
+            continue;
+        }
+        if (strategy == WAIT_STRATEGY_SPIN) {
+            thread_yield();
+            spin = 0;
+            continue;
+        }
+
+        // 先读epoch再登记：登记之后的通知一定会改变epoch，休眠会立即返回
+        uint32_t observed = atomic_load_explicit(&event->epoch, memory_order_acquire);
+        atomic_fetch_add_explicit(&event->waiters, 1, memory_order_seq_cst);
+        if (!ready(context)) {
+            atomic_wait_u32(&event->epoch, observed);
+        }
+        atomic_fetch_sub_explicit(&event->waiters, 1, memory_order_relaxed);
+    }
+}
+
+void wait_event_notify(WaitEvent* event, bool all) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&event->waiters, memory_order_relaxed) == 0) return;
+
+    atomic_fetch_add_explicit(&event->epoch, 1, memory_order_release);
+    if (all) {
+        atomic_wake_all(&event->epoch);
+    }
+    else {
+        atomic_wake_one(&event->epoch);
+    }
+}
@@ -0,0 +1,56 @@
+﻿#pragma once
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "typedefs.h"
+
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// 线程间等待与唤醒：在一个32位原子变量上阻塞，直到其他线程修改它并唤醒
+// Linux使用futex，Windows使用WaitOnAddress，其他平台退化为让出CPU的轮询
+
+// 队列等待策略
+typedef enum {
+    WAIT_STRATEGY_SPIN,   // 忙等，偶尔让出CPU；延迟最低，等待时占满一个核
+    WAIT_STRATEGY_BLOCK   // 短暂自旋后在原子变量上阻塞，等待时不占CPU
+} WaitStrategy;
+
+// 等待事件：等待方登记后在epoch上休眠，通知方发布状态后只在有人登记时才递增epoch并唤醒
+// 等待方“登记-重查条件”、通知方“发布-检查登记”之间都有全屏障，不会丢失唤醒
+typedef struct {
+    atomic_uint waiters;  // 正在休眠或准备休眠的线程数
+    atomic_uint epoch;    // 每次唤醒加1
+} WaitEvent;
+
+// 等待条件，ready(context)为true时返回
+typedef bool (*WaitCondition)(void* context);
+
+// 阻塞直到*address不等于expected或被唤醒，可能虚假返回，调用方须重新检查条件
+API void atomic_wait_u32(atomic_uint* address, uint32_t expected);
+
+// 唤醒一个或全部等待在address上的线程
+API void atomic_wake_one(atomic_uint* address);
+API void atomic_wake_all(atomic_uint* address);
+
+// 初始化等待事件
+API void wait_event_init(WaitEvent* event);
+
+// 按策略等待ready(context)成立：先自旋，SPIN策略之后让出CPU继续轮询，BLOCK策略之后在事件上休眠
+API void wait_event_wait(WaitEvent* event, WaitStrategy strategy, WaitCondition ready, void* context);
+
+// 在发布新状态之后调用，有线程在等待时唤醒一个或全部
+API void wait_event_notify(WaitEvent* event, bool all);
+
+// 自旋等待中的CPU提示
+static inline void cpu_relax(void) {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+// 让出当前线程的时间片
+API void thread_yield(void);
@@ -0,0 +1,325 @@
+﻿#include <string.h>
+#include "cache.h"
+#include "core/logger/assert.h"
+#include "core/logger/log.h"
+
+#define NIL UINT32_MAX
+
+// 条目头部，键和值紧随其后
+// 使用中的条目在LRU策略下位于最近访问链表中，空闲条目用next串成空闲链表
+typedef struct {
+    uint32_t prev;
+    uint32_t next;
+    size_t hash;          // 键的哈希值，淘汰时从索引中删除不用重新计算
+    size_t bytes;         // 计入的字节数
+    bool used;            // 是否保存着有效条目
+    bool referenced;      // CLOCK策略的引用位
+} CacheNode;
+
+struct Cache {
+    HashMap index;        // 键 -> 条目下标
+    char* nodes;          // 条目数组
+    uint32_t node_count;  // 已使用过的条目数量（含空闲条目）
+    uint32_t node_capacity;
+    uint32_t free_list;   // 空闲条目链表
+    uint32_t head;        // 最近访问的条目
+    uint32_t tail;        // 最久未访问的条目
+    uint32_t hand;        // CLOCK策略的指针
+    size_t node_size;
+    size_t key_offset;
+    size_t value_offset;
+    size_t key_size;
+    size_t value_size;
+    size_t size;
+    size_t bytes;
+    size_t max_entries;
+    size_t max_bytes;
+    CachePolicy policy;
+    CacheStats stats;
+    CacheEvictCallback on_evict;
+    void* evict_user_data;
+    Allocator* allocator;
+};
+
+static CacheNode* node_at(const Cache cache, uint32_t index) {
+    return (CacheNode*)(cache->nodes + (size_t)index * cache->node_size);
+}
+
+static void* node_key(const Cache cache, uint32_t index) {
+    return (char*)node_at(cache, index) + cache->key_offset;
+}
+
+static void* node_value(const Cache cache, uint32_t index) {
+    return (char*)node_at(cache, index) + cache->value_offset;
+}
+
+static size_t align_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// 从最近访问链表中摘下
+static void list_unlink(Cache cache, uint32_t index) {
+    CacheNode* node = node_at(cache, index);
+    if (node->prev != NIL) node_at(cache, node->prev)->next = node->next;
+    else cache->head = node->next;
+    if (node->next != NIL) node_at(cache, node->next)->prev = node->prev;
+    else cache->tail = node->prev;
+}
+
+// 放到最近访问链表头部
+static void list_push_front(Cache cache, uint32_t index) {
+    CacheNode* node = node_at(cache, index);
+    node->prev = NIL;
+    node->next = cache->head;
+    if (cache->head != NIL) node_at(cache, cache->head)->prev = index;
+    else cache->tail = index;
+    cache->head = index;
+}
+
+// 记录一次访问
+static void touch(Cache cache, uint32_t index) {
+    if (cache->policy == CACHE_POLICY_LRU) {
+        if (cache->head != index) {
+            list_unlink(cache, index);
+            list_push_front(cache, index);
+        }
+    }
+    else {
+        node_at(cache, index)->referenced = true;
+    }
+}
+
+static uint32_t allocate_node(Cache cache) {
+    if (cache->free_list != NIL) {
+        uint32_t index = cache->free_list;
+        cache->free_list = node_at(cache, index)->next;
+        return index;
+    }
+
+    if (cache->node_count == cache->node_capacity) {
+        ASSERT_MSG(cache->node_capacity < CACHE_MAX_ENTRIES, "Cache entry index exhausted");
+        uint32_t new_capacity = cache->node_capacity > CACHE_MAX_ENTRIES / 2 ? CACHE_MAX_ENTRIES
+            : cache->node_capacity ? cache->node_capacity * 2 : 16;
+        cache->nodes = allocator_reallocate(cache->allocator, cache->nodes,
+            (size_t)cache->node_capacity * cache->node_size, (size_t)new_capacity * cache->node_size);
+        cache->node_capacity = new_capacity;
+    }
+    return cache->node_count++;
+}
+
+// 删除条目并放回空闲链表
+static void remove_node(Cache cache, uint32_t index) {
+    CacheNode* node = node_at(cache, index);
+    hashmap_erase_hashed(cache->index, node_key(cache, index), node->hash);
+    if (cache->policy == CACHE_POLICY_LRU) {
+        list_unlink(cache, index);
+    }
+    node->used = false;
+    node->next = cache->free_list;
+    cache->free_list = index;
+    cache->size--;
+    cache->bytes -= node->bytes;
+}
+
+// 选出下一个被淘汰的条目，不选keep
+static uint32_t select_victim(Cache cache, uint32_t keep) {
+    if (cache->policy == CACHE_POLICY_LRU) {
+        uint32_t victim = cache->tail;
+        return victim == keep ? node_at(cache, victim)->prev : victim;
+    }
+
+    // 转动指针：引用位为1的条目清零后跳过，最多两圈一定能找到
+    for (;;) {
+        uint32_t index = cache->hand;
+        cache->hand = cache->hand + 1 == cache->node_count ? 0 : cache->hand + 1;
+        CacheNode* node = node_at(cache, index);
+        if (!node->used || index == keep) continue;
+        if (node->referenced) {
+            node->referenced = false;
+            continue;
+        }
+        return index;
+    }
+}
+
+static void evict(Cache cache, uint32_t victim) {
+    if (cache->on_evict) {
+        cache->on_evict(node_key(cache, victim), node_value(cache, victim), cache->evict_user_data);
+    }
+    remove_node(cache, victim);
+    cache->stats.evictions++;
+}
+
+// 淘汰条目直到再加入extra_entries个条目、extra_bytes字节后不超出容量
+static void make_room(Cache cache, size_t extra_entries, size_t extra_bytes, uint32_t keep) {
+    size_t others = keep == NIL ? cache->size : cache->size - 1;
+    while (others > 0 &&
+        ((cache->max_entries && cache->size + extra_entries > cache->max_entries) ||
+         (cache->max_bytes && cache->bytes + extra_bytes > cache->max_bytes))) {
+        evict(cache, select_victim(cache, keep));
+        others--;
+    }
+}
+
+Cache cache_create(size_t key_size, size_t value_size,
+    HashFunc hash_func, KeyEqual key_equal,
+    CachePolicy policy, size_t max_entries, size_t max_bytes,
+    Allocator* allocator) {
+    if (!allocator) allocator = get_default_allocator();
+    ASSERT_MSG(max_entries || max_bytes, "Cache needs max_entries or max_bytes");
+    if (max_entries > CACHE_MAX_ENTRIES) {
+        LOG_WARN("Cache max_entries %zu exceeds %zu, clamped", max_entries, (size_t)CACHE_MAX_ENTRIES);
+        max_entries = CACHE_MAX_ENTRIES;
+    }
+
+    Cache cache = allocator_allocate(allocator, sizeof(struct Cache));
+    memset(cache, 0, sizeof(struct Cache));
+    cache->index = hashmap_create(key_size, sizeof(uint32_t), hash_func, key_equal, allocator);
+    cache->free_list = NIL;
+    cache->head = NIL;
+    cache->tail = NIL;
+    cache->key_size = key_size;
+    cache->value_size = value_size;
+    cache->key_offset = align_up(sizeof(CacheNode), ALLOCATOR_DEFAULT_ALIGNMENT);
+    cache->value_offset = align_up(cache->key_offset + key_size, ALLOCATOR_DEFAULT_ALIGNMENT);
+    cache->node_size = align_up(cache->value_offset + value_size, ALLOCATOR_DEFAULT_ALIGNMENT);
+    cache->max_entries = max_entries;
+    cache->max_bytes = max_bytes;
+    cache->policy = policy;
+    cache->allocator = allocator;
+
+    // 条目数有上限时一次分配好条目数组和索引，之后不再扩容
+    if (max_entries) {
+        cache->node_capacity = (uint32_t)max_entries;
+        cache->nodes = allocator_allocate(allocator, max_entries * cache->node_size);
+        hashmap_reserve(cache->index, max_entries);
+    }
+    return cache;
+}
+
+void cache_destroy(Cache cache) {
+    hashmap_destroy(cache->index);
+    allocator_deallocate(cache->allocator, cache->nodes, (size_t)cache->node_capacity * cache->node_size);
+    allocator_deallocate(cache->allocator, cache, sizeof(struct Cache));
+}
+
+void cache_set_evict_callback(Cache cache, CacheEvictCallback callback, void* user_data) {
+    cache->on_evict = callback;
+    cache->evict_user_data = user_data;
+}
+
+void* cache_find(Cache cache, const void* key) {
+    uint32_t* index = hashmap_find_hashed(cache->index, key, hashmap_hash_key(cache->index, key));
+    if (!index) {
+        cache->stats.misses++;
+        return NULL;
+    }
+    cache->stats.hits++;
+    touch(cache, *index);
+    return node_value(cache, *index);
+}
+
+bool cache_get(Cache cache, const void* key, void* value_out) {
+    void* value = cache_find(cache, key);
+    if (!value) return false;
+
+    if (value_out) {
+        memcpy(value_out, value, cache->value_size);
+    }
+    return true;
+}
+
+bool cache_peek(const Cache cache, const void* key, void* value_out) {
+    uint32_t* index = hashmap_find_hashed(cache->index, key, hashmap_hash_key(cache->index, key));
+    if (!index) return false;
+
+    if (value_out) {
+        memcpy(value_out, node_value(cache, *index), cache->value_size);
+    }
+    return true;
+}
+
+bool cache_put_sized(Cache cache, const void* key, const void* value, size_t bytes) {
+    size_t hash = hashmap_hash_key(cache->index, key);
+    uint32_t* existing = hashmap_find_hashed(cache->index, key, hash);
+
+    if (cache->max_bytes && bytes > cache->max_bytes) {
+        if (existing) remove_node(cache, *existing);
+        return false;
+    }
+
+    if (existing) {
+        uint32_t index = *existing;
+        CacheNode* node = node_at(cache, index);
+        cache->bytes = cache->bytes - node->bytes + bytes;
+        node->bytes = bytes;
+        memcpy(node_value(cache, index), value, cache->value_size);
+        touch(cache, index);
+        make_room(cache, 0, 0, index);
+        return false;
+    }
+
+    make_room(cache, 1, bytes, NIL);
+
+    uint32_t index = allocate_node(cache);
+    CacheNode* node = node_at(cache, index);
+    node->hash = hash;
+    node->bytes = bytes;
+    node->used = true;
+    node->referenced = false;
+    memcpy(node_key(cache, index), key, cache->key_size);
+    memcpy(node_value(cache, index), value, cache->value_size);
+    if (cache->policy == CACHE_POLICY_LRU) {
+        list_push_front(cache, index);
+    }
+
+    bool inserted;
+    *(uint32_t*)hashmap_emplace_hashed(cache->index, key, hash, &inserted) = index;
+    cache->size++;
+    cache->bytes += bytes;
+    cache->stats.insertions++;
+    return true;
+}
+
+bool cache_put(Cache cache, const void* key, const void* value) {
+    return cache_put_sized(cache, key, value, cache->key_size + cache->value_size);
+}
+
+size_t cache_erase(Cache cache, const void* key) {
+    uint32_t* index = hashmap_find_hashed(cache->index, key, hashmap_hash_key(cache->index, key));
+    if (!index) return 0;
+
+    remove_node(cache, *index);
+    return 1;
+}
+
+bool cache_contains(const Cache cache, const void* key) {
+    return hashmap_contains(cache->index, key);
+}
+
+void cache_clear(Cache cache) {
+    hashmap_clear(cache->index);
+    cache->node_count = 0;
+    cache->free_list = NIL;
+    cache->head = NIL;
+    cache->tail = NIL;
+    cache->hand = 0;
+    cache->size = 0;
+    cache->bytes = 0;
+}
+
+size_t cache_size(const Cache cache) {
+    return cache->size;
+}
+
+size_t cache_bytes(const Cache cache) {
+    return cache->bytes;
+}
+
+CacheStats cache_stats(const Cache cache) {
+    return cache->stats;
+}
+
+void cache_reset_stats(Cache cache) {
+    memset(&cache->stats, 0, sizeof(CacheStats));
+}
@@ -0,0 +1,73 @@
+﻿#pragma once
+#include "hash_map.h"
+
+// 有界缓存：条目连续存放在数组中，淘汰顺序用条目内联的下标链表维护
+// 键到条目下标的索引是一个HashMap；设置max_entries时条目数组和索引在创建时一次分配好，
+// 读取不分配内存，写入只在索引中的删除标记积累到需要原容量重建时分配一次新表
+typedef struct Cache* Cache;
+
+// 条目用32位下标链接，UINT32_MAX保留为空链接
+#define CACHE_MAX_ENTRIES (UINT32_MAX - 1)
+
+typedef enum {
+    CACHE_POLICY_LRU,     // 淘汰最久未访问的条目
+    CACHE_POLICY_CLOCK    // 时钟近似LRU：访问只设置引用位，不移动条目
+} CachePolicy;
+
+typedef struct {
+    size_t hits;          // 命中次数
+    size_t misses;        // 未命中次数
+    size_t insertions;    // 新插入次数
+    size_t evictions;     // 因容量淘汰的次数
+} CacheStats;
+
+// 条目因容量被淘汰时调用，value可以在回调中释放其引用的资源
+typedef void (*CacheEvictCallback)(const void* key, void* value, void* user_data);
+
+// 创建缓存，max_entries限制条目数（不超过CACHE_MAX_ENTRIES），max_bytes限制总占用字节数，为0表示不限制，两者至少设置一个
+// 其余参数同hashmap_create
+API Cache cache_create(size_t key_size, size_t value_size,
+    HashFunc hash_func, KeyEqual key_equal,
+    CachePolicy policy, size_t max_entries, size_t max_bytes,
+    Allocator* allocator);
+
+// 销毁缓存，不调用淘汰回调
+API void cache_destroy(Cache cache);
+
+// 设置淘汰回调
+API void cache_set_evict_callback(Cache cache, CacheEvictCallback callback, void* user_data);
+
+// 查找并复制值，命中时记为最近访问
+API bool cache_get(Cache cache, const void* key, void* value_out);
+
+// 查找值的地址，命中时记为最近访问，不存在返回NULL；地址在下一次插入或删除前有效
+API void* cache_find(Cache cache, const void* key);
+
+// 查找值但不更新访问记录和统计
+API bool cache_peek(const Cache cache, const void* key, void* value_out);
+
+// 插入或更新，按key_size + value_size计入字节数，必要时先淘汰其他条目；返回是否为新插入
+API bool cache_put(Cache cache, const void* key, const void* value);
+
+// 插入或更新并指定计入的字节数（例如值引用的外部内存大小）
+// bytes超过max_bytes时不缓存，并删除已有的同键条目
+API bool cache_put_sized(Cache cache, const void* key, const void* value, size_t bytes);
+
+// 删除条目，不调用淘汰回调，返回删除的数量
+API size_t cache_erase(Cache cache, const void* key);
+
+// 检查键是否存在，不更新访问记录
+API bool cache_contains(const Cache cache, const void* key);
+
+// 清空缓存，不调用淘汰回调
+API void cache_clear(Cache cache);
+
+// 条目数
+API size_t cache_size(const Cache cache);
+
+// 当前计入的总字节数
+API size_t cache_bytes(const Cache cache);
+
+// 获取和重置统计
+API CacheStats cache_stats(const Cache cache);
+API void cache_reset_stats(Cache cache);
@@ -0,0 +1,177 @@
+﻿// 以C17编译时系统头文件默认不声明pthread_rwlock_t，须在包含任何头文件之前开启
+#define _POSIX_C_SOURCE 200809L
+#include <string.h>
+#include "concurrent_hash_map.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#define CACHE_LINE_SIZE 64
+
+#ifdef _WIN32
+typedef SRWLOCK RwLock;
+
+static void rwlock_init(RwLock* lock) { InitializeSRWLock(lock); }
+static void rwlock_destroy(RwLock* lock) { (void)lock; }
+static void rwlock_read_lock(RwLock* lock) { AcquireSRWLockShared(lock); }
+static void rwlock_read_unlock(RwLock* lock) { ReleaseSRWLockShared(lock); }
+static void rwlock_write_lock(RwLock* lock) { AcquireSRWLockExclusive(lock); }
+static void rwlock_write_unlock(RwLock* lock) { ReleaseSRWLockExclusive(lock); }
+#else
+typedef pthread_rwlock_t RwLock;
+
+static void rwlock_init(RwLock* lock) { pthread_rwlock_init(lock, NULL); }
+static void rwlock_destroy(RwLock* lock) { pthread_rwlock_destroy(lock); }
+static void rwlock_read_lock(RwLock* lock) { pthread_rwlock_rdlock(lock); }
+static void rwlock_read_unlock(RwLock* lock) { pthread_rwlock_unlock(lock); }
+static void rwlock_write_lock(RwLock* lock) { pthread_rwlock_wrlock(lock); }
+static void rwlock_write_unlock(RwLock* lock) { pthread_rwlock_unlock(lock); }
+#endif
+
+// 每个分片独占缓存行，避免相邻分片的锁互相干扰
+// 分片内的HashMap不开启增量重建，查找不会修改表，可以只持有读锁
+typedef struct {
+    _Alignas(CACHE_LINE_SIZE) RwLock lock;
+    HashMap map;
+} Shard;
+
+struct ConcurrentHashMap {
+    Shard* shards;
+    size_t shard_count;
+    uint32_t shard_shift;   // 选择分片时取混合后哈希值的高位
+    size_t value_size;
+    Allocator* allocator;
+};
+
+static Shard* shard_for(const ConcurrentHashMap map, size_t hash) {
+    if (map->shard_count == 1) {
+        return map->shards;
+    }
+    // 再做一次乘法混合，低位质量差的用户哈希函数也能均匀分布到各分片
+    return &map->shards[((uint64_t)hash * 0x9E3779B97F4A7C15ull) >> map->shard_shift];
+}
+
+ConcurrentHashMap concurrent_hashmap_create(size_t key_size, size_t value_size,
+    HashFunc hash_func, KeyEqual key_equal, size_t shard_count, Allocator* allocator) {
+    if (!allocator) allocator = get_default_allocator();
+    if (shard_count == 0) shard_count = CONCURRENT_HASHMAP_DEFAULT_SHARDS;
+
+    uint32_t shard_bits = 0;
+    while (((size_t)1 << shard_bits) < shard_count) {
+        shard_bits++;
+    }
+
+    ConcurrentHashMap map = allocator_allocate(allocator, sizeof(struct ConcurrentHashMap));
+    map->shard_count = (size_t)1 << shard_bits;
+    map->shard_shift = 64 - shard_bits;
+    map->value_size = value_size;
+    map->allocator = allocator;
+    map->shards = allocator_allocate_aligned(allocator, map->shard_count * sizeof(Shard), CACHE_LINE_SIZE);
+
+    for (size_t i = 0; i < map->shard_count; i++) {
+        rwlock_init(&map->shards[i].lock);
+        map->shards[i].map = hashmap_create(key_size, value_size, hash_func, key_equal, allocator);
+    }
+    return map;
+}
+
+void concurrent_hashmap_destroy(ConcurrentHashMap map) {
+    for (size_t i = 0; i < map->shard_count; i++) {
+        hashmap_destroy(map->shards[i].map);
+        rwlock_destroy(&map->shards[i].lock);
+    }
+    allocator_deallocate_aligned(map->allocator, map->shards, map->shard_count * sizeof(Shard), CACHE_LINE_SIZE);
+    allocator_deallocate(map->allocator, map, sizeof(struct ConcurrentHashMap));
+}
+
+bool concurrent_hashmap_insert(ConcurrentHashMap map, const void* key, const void* value) {
+    // 所有分片使用相同的哈希函数，哈希值在锁外计算一次，分片内复用
+    size_t hash = hashmap_hash_key(map->shards[0].map, key);
+    Shard* shard = shard_for(map, hash);
+
+    rwlock_write_lock(&shard->lock);
+    bool inserted;
+    void* dest = hashmap_emplace_hashed(shard->map, key, hash, &inserted);
+    memcpy(dest, value, map->value_size);
+    rwlock_write_unlock(&shard->lock);
+    return inserted;
+}
+
+bool concurrent_hashmap_get(ConcurrentHashMap map, const void* key, void* value_out) {
+    size_t hash = hashmap_hash_key(map->shards[0].map, key);
+    Shard* shard = shard_for(map, hash);
+
+    rwlock_read_lock(&shard->lock);
+    void* value = hashmap_find_hashed(shard->map, key, hash);
+    if (value && value_out) {
+        memcpy(value_out, value, map->value_size);
+    }
+    rwlock_read_unlock(&shard->lock);
+    return value != NULL;
+}
+
+bool concurrent_hashmap_contains(ConcurrentHashMap map, const void* key) {
+    return concurrent_hashmap_get(map, key, NULL);
+}
+
+size_t concurrent_hashmap_erase(ConcurrentHashMap map, const void* key) {
+    size_t hash = hashmap_hash_key(map->shards[0].map, key);
+    Shard* shard = shard_for(map, hash);
+
+    rwlock_write_lock(&shard->lock);
+    size_t erased = hashmap_erase_hashed(shard->map, key, hash);
+    rwlock_write_unlock(&shard->lock);
+    return erased;
+}
+
+bool concurrent_hashmap_compute_if_absent(ConcurrentHashMap map, const void* key,
+    ValueFactory factory, void* user_data, void* value_out) {
+    size_t hash = hashmap_hash_key(map->shards[0].map, key);
+    Shard* shard = shard_for(map, hash);
+
+    // 先在读锁下查找，命中时不阻塞其他读者
+    rwlock_read_lock(&shard->lock);
+    void* value = hashmap_find_hashed(shard->map, key, hash);
+    if (value) {
+        if (value_out) memcpy(value_out, value, map->value_size);
+        rwlock_read_unlock(&shard->lock);
+        return false;
+    }
+    rwlock_read_unlock(&shard->lock);
+
+    // 未命中时在写锁下再查一次，其他线程可能已经插入
+    rwlock_write_lock(&shard->lock);
+    bool inserted;
+    value = hashmap_emplace_hashed(shard->map, key, hash, &inserted);
+    if (inserted) {
+        factory(key, value, user_data);
+    }
+    if (value_out) memcpy(value_out, value, map->value_size);
+    rwlock_write_unlock(&shard->lock);
+    return inserted;
+}
+
+size_t concurrent_hashmap_size(ConcurrentHashMap map) {
+    size_t size = 0;
+    for (size_t i = 0; i < map->shard_count; i++) {
+        rwlock_read_lock(&map->shards[i].lock);
+        size += hashmap_size(map->shards[i].map);
+        rwlock_read_unlock(&map->shards[i].lock);
+    }
+    return size;
+}
+
+void concurrent_hashmap_clear(ConcurrentHashMap map) {
+    for (size_t i = 0; i < map->shard_count; i++) {
+        rwlock_write_lock(&map->shards[i].lock);
+        hashmap_clear(map->shards[i].map);
+        rwlock_write_unlock(&map->shards[i].lock);
+    }
+}
+
+size_t concurrent_hashmap_shard_count(const ConcurrentHashMap map) {
+    return map->shard_count;
+}
@@ -0,0 +1,45 @@
+﻿#pragma once
+#include "hash_map.h"
+
+// 分片并发哈希表：键按哈希值分到多个分片，每个分片是一个带读写锁的HashMap
+// 查找只加分片的读锁，不同分片上的写入互不阻塞
+typedef struct ConcurrentHashMap* ConcurrentHashMap;
+
+// 为不存在的键构造值，写入value_out
+typedef void (*ValueFactory)(const void* key, void* value_out, void* user_data);
+
+// 默认分片数
+#define CONCURRENT_HASHMAP_DEFAULT_SHARDS 64
+
+// 创建并发哈希表，shard_count向上取整为2的幂（0使用默认值），其余参数同hashmap_create
+API ConcurrentHashMap concurrent_hashmap_create(size_t key_size, size_t value_size,
+    HashFunc hash_func, KeyEqual key_equal, size_t shard_count, Allocator* allocator);
+
+// 销毁并发哈希表，调用时不能有其他线程在使用
+API void concurrent_hashmap_destroy(ConcurrentHashMap map);
+
+// 插入或更新键值对，返回是否为新插入
+API bool concurrent_hashmap_insert(ConcurrentHashMap map, const void* key, const void* value);
+
+// 查找值并复制到value_out
+API bool concurrent_hashmap_get(ConcurrentHashMap map, const void* key, void* value_out);
+
+// 检查键是否存在
+API bool concurrent_hashmap_contains(ConcurrentHashMap map, const void* key);
+
+// 删除键值对，返回删除的数量
+API size_t concurrent_hashmap_erase(ConcurrentHashMap map, const void* key);
+
+// 键存在时复制现有值；不存在时在分片写锁内调用factory构造值并插入，保证每个键只构造一次
+// value_out可为NULL；factory不能访问同一个map；返回是否新构造
+API bool concurrent_hashmap_compute_if_absent(ConcurrentHashMap map, const void* key,
+    ValueFactory factory, void* user_data, void* value_out);
+
+// 元素总数，其他线程同时修改时只是近似值
+API size_t concurrent_hashmap_size(ConcurrentHashMap map);
+
+// 清空所有分片
+API void concurrent_hashmap_clear(ConcurrentHashMap map);
+
+// 分片数
+API size_t concurrent_hashmap_shard_count(const ConcurrentHashMap map);
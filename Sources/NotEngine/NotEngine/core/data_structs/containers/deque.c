@@ -2,74 +2,108 @@
 #include <string.h>
 #include "deque.h"
 
-#define BLOCK_SIZE 8
 #define INITIAL_MAP_SIZE 8
 
-// 数据块结构
-typedef struct {
-    void* data;  // 数据块内存
-} Block;
-
 // 双端队列结构
+// 块数组中[front_block, back_block]的块都已分配，元素依次存放在从首块front_pos开始的size个位置
+// back_block是最后一个元素所在的块，deque为空时等于front_block
 struct Deque {
-    Block** blocks;       // 块指针数组
+    char** blocks;        // 块数组，直接保存各块数据的地址
     size_t block_count;   // 块数组大小
     size_t front_block;   // 首元素所在块
-    size_t front_pos;     // 首元素在块中位置
-    size_t back_block;    // 尾元素所在块
-    size_t back_pos;      // 尾元素在块中位置
+    size_t front_pos;     // 首元素在块中位置，总是小于block_elems
+    size_t back_block;    // 末块
     size_t size;          // 元素个数
     size_t elem_size;     // 元素大小
+    size_t block_elems;   // 每块元素数，2的幂，下标换算成块和块内位置只需移位和掩码
+    size_t block_shift;   // log2(block_elems)
+    size_t block_bytes;   // 每块字节数
+    char* spare[DEQUE_SPARE_BLOCKS]; // 空出的块先留在这里复用，在块边界来回时不反复分配
+    size_t spare_count;
     Allocator* allocator; // 内存分配器
 };
 
 // 创建新的数据块
-static Block* create_block(Deque deque) {
-    Block* block = deque->allocator->allocate(sizeof(Block));
-    block->data = deque->allocator->allocate(BLOCK_SIZE * deque->elem_size);
-    return block;
+static char* create_block(Deque deque) {
+    if (deque->spare_count) {
+        return deque->spare[--deque->spare_count];
+    }
+    return allocator_allocate(deque->allocator, deque->block_bytes);
 }
 
 // 销毁数据块
-static void destroy_block(Deque deque, Block* block) {
-    deque->allocator->deallocate(block->data);
-    deque->allocator->deallocate(block);
-}
-
-// 确保有足够的块空间
-static void ensure_capacity(Deque deque) {
-    if (deque->back_block - deque->front_block < deque->block_count - 2) {
+static void destroy_block(Deque deque, char* block) {
+    if (deque->spare_count < DEQUE_SPARE_BLOCKS) {
+        deque->spare[deque->spare_count++] = block;
         return;
     }
-     
-    size_t new_count = deque->block_count * 2;
-    Block** new_blocks = deque->allocator->allocate(new_count * sizeof(Block*));
+    allocator_deallocate(deque->allocator, block, deque->block_bytes);
+}
 
-    // 移动现有块到新数组中间
-    size_t new_front = (new_count - (deque->back_block - deque->front_block)) / 2;
-    for (size_t i = deque->front_block; i <= deque->back_block; i++) {
-        new_blocks[new_front + (i - deque->front_block)] = deque->blocks[i];
+// 第index个元素的地址
+static char* element_at(const Deque deque, size_t index) {
+    size_t offset = deque->front_pos + index;
+    return deque->blocks[deque->front_block + (offset >> deque->block_shift)] +
+        (offset & (deque->block_elems - 1)) * deque->elem_size;
+}
+
+// 把已分配的块移到块数组中间，空间不足一半时先把块数组加倍
+static void recenter_map(Deque deque) {
+    size_t used = deque->back_block - deque->front_block + 1;
+    size_t new_count = deque->block_count;
+    while (used * 2 > new_count) {
+        new_count *= 2;
     }
+    size_t new_front = (new_count - used) / 2;
 
-    deque->allocator->deallocate(deque->blocks);
-    deque->blocks = new_blocks;
-    deque->back_block = new_front + (deque->back_block - deque->front_block);
+    if (new_count == deque->block_count) {
+        memmove(deque->blocks + new_front, deque->blocks + deque->front_block, used * sizeof(char*));
+    }
+    else {
+        char** new_blocks = allocator_allocate(deque->allocator, new_count * sizeof(char*));
+        memcpy(new_blocks + new_front, deque->blocks + deque->front_block, used * sizeof(char*));
+        allocator_deallocate(deque->allocator, deque->blocks, deque->block_count * sizeof(char*));
+        deque->blocks = new_blocks;
+        deque->block_count = new_count;
+    }
     deque->front_block = new_front;
-    deque->block_count = new_count;
+    deque->back_block = new_front + used - 1;
+}
+
+// 确保首块之前和末块之后都还有空位
+static void ensure_capacity(Deque deque) {
+    if (deque->front_block == 0 || deque->back_block + 1 == deque->block_count) {
+        recenter_map(deque);
+    }
 }
 
 Deque deque_create(size_t elem_size, Allocator* allocator) {
+    return deque_create_with_block_size(elem_size, DEQUE_DEFAULT_BLOCK_BYTES, allocator);
+}
+
+Deque deque_create_with_block_size(size_t elem_size, size_t block_bytes, Allocator* allocator) {
     if (!allocator) allocator = get_default_allocator();
 
-    Deque deque = allocator->allocate(sizeof(Deque));
-    deque->blocks = allocator->allocate(INITIAL_MAP_SIZE * sizeof(Block*));
+    Deque deque = allocator_allocate(allocator, sizeof(struct Deque));
+    memset(deque, 0, sizeof(struct Deque));
+    deque->blocks = allocator_allocate(allocator, INITIAL_MAP_SIZE * sizeof(char*));
     deque->block_count = INITIAL_MAP_SIZE;
     deque->elem_size = elem_size;
     deque->allocator = allocator;
 
+    // 每块元素数取不超过block_bytes / elem_size的2的幂，至少1个
+    size_t fit = elem_size ? block_bytes / elem_size : block_bytes;
+    deque->block_elems = 1;
+    deque->block_shift = 0;
+    while (deque->block_elems * 2 <= fit) {
+        deque->block_elems *= 2;
+        deque->block_shift++;
+    }
+    deque->block_bytes = deque->block_elems * elem_size;
+
     // 初始化为中间位置
     deque->front_block = deque->back_block = INITIAL_MAP_SIZE / 2;
-    deque->front_pos = deque->back_pos = BLOCK_SIZE / 2;
+    deque->front_pos = deque->block_elems / 2;
     deque->size = 0;
 
     // 创建初始块
@@ -79,77 +113,91 @@ Deque deque_create(size_t elem_size, Allocator* allocator) {
 
 void deque_destroy(Deque deque) {
     for (size_t i = deque->front_block; i <= deque->back_block; i++) {
-        destroy_block(deque, deque->blocks[i]);
+        allocator_deallocate(deque->allocator, deque->blocks[i], deque->block_bytes);
+    }
+    for (size_t i = 0; i < deque->spare_count; i++) {
+        allocator_deallocate(deque->allocator, deque->spare[i], deque->block_bytes);
     }
-    deque->allocator->deallocate(deque->blocks);
-    deque->allocator->deallocate(deque);
+    allocator_deallocate(deque->allocator, deque->blocks, deque->block_count * sizeof(char*));
+    allocator_deallocate(deque->allocator, deque, sizeof(struct Deque));
 }
 
 void deque_push_front(Deque deque, const void* elem) {
     if (deque->front_pos == 0) {
-        ensure_capacity(deque);
-        deque->front_block--;
-        deque->blocks[deque->front_block] = create_block(deque);
-        deque->front_pos = BLOCK_SIZE;
+        // 空deque直接从唯一的块末尾开始，否则末块会成为不含元素的块
+        if (deque->size > 0) {
+            ensure_capacity(deque);
+            deque->front_block--;
+            deque->blocks[deque->front_block] = create_block(deque);
+        }
+        deque->front_pos = deque->block_elems;
     }
 
     deque->front_pos--;
-    memcpy((char*)deque->blocks[deque->front_block]->data +
-        deque->front_pos * deque->elem_size, elem, deque->elem_size);
     deque->size++;
+    memcpy(element_at(deque, 0), elem, deque->elem_size);
 }
 
 void deque_push_back(Deque deque, const void* elem) {
-    if (deque->back_pos == BLOCK_SIZE) {
+    size_t offset = deque->front_pos + deque->size;
+    if (deque->front_block + (offset >> deque->block_shift) > deque->back_block) {
         ensure_capacity(deque);
         deque->back_block++;
         deque->blocks[deque->back_block] = create_block(deque);
-        deque->back_pos = 0;
     }
 
-    memcpy((char*)deque->blocks[deque->back_block]->data +
-        deque->back_pos * deque->elem_size, elem, deque->elem_size);
-    deque->back_pos++;
     deque->size++;
+    memcpy(element_at(deque, deque->size - 1), elem, deque->elem_size);
 }
 
 void deque_pop_front(Deque deque) {
     if (deque->size == 0) return;
 
     deque->front_pos++;
-    if (deque->front_pos == BLOCK_SIZE) {
-        destroy_block(deque, deque->blocks[deque->front_block]);
-        deque->front_block++;
-        deque->front_pos = 0;
-    }
     deque->size--;
+    if (deque->front_pos == deque->block_elems) {
+        if (deque->front_block < deque->back_block) {
+            destroy_block(deque, deque->blocks[deque->front_block]);
+            deque->front_block++;
+            deque->front_pos = 0;
+        }
+        else {
+            // 唯一的块已经取空，保留它并回到块中间
+            deque->front_pos = deque->block_elems / 2;
+        }
+    }
 }
 
 void deque_pop_back(Deque deque) {
     if (deque->size == 0) return;
 
-    if (deque->back_pos == 0) {
+    deque->size--;
+    // 末块不再含有元素时释放，首块总是保留；末块总是最后一个元素所在的块
+    size_t last = deque->size ? (deque->front_pos + deque->size - 1) >> deque->block_shift : 0;
+    if (deque->front_block + last < deque->back_block) {
         destroy_block(deque, deque->blocks[deque->back_block]);
         deque->back_block--;
-        deque->back_pos = BLOCK_SIZE;
     }
-    deque->back_pos--;
-    deque->size--;
 }
 
 void deque_front(const Deque deque, void* dest) {
-    memcpy(dest,
-        (char*)deque->blocks[deque->front_block]->data +
-        deque->front_pos * deque->elem_size,
-        deque->elem_size);
+    memcpy(dest, element_at(deque, 0), deque->elem_size);
 }
 
 void deque_back(const Deque deque, void* dest) {
-    size_t pos = deque->back_pos > 0 ? deque->back_pos - 1 : BLOCK_SIZE - 1;
-    memcpy(dest,
-        (char*)deque->blocks[deque->back_block]->data +
-        pos * deque->elem_size,
-        deque->elem_size);
+    memcpy(dest, element_at(deque, deque->size - 1), deque->elem_size);
+}
+
+void* deque_at(const Deque deque, size_t index) {
+    return element_at(deque, index);
+}
+
+void deque_get(const Deque deque, size_t index, void* dest) {
+    memcpy(dest, element_at(deque, index), deque->elem_size);
+}
+
+void deque_set(Deque deque, size_t index, const void* element) {
+    memcpy(element_at(deque, index), element, deque->elem_size);
 }
 
 size_t deque_size(const Deque deque)
@@ -162,8 +210,43 @@ bool deque_empty(const Deque deque)
     return deque->size == 0;
 }
 
+void deque_clear(Deque deque) {
+    // 只保留首块
+    for (size_t i = deque->front_block + 1; i <= deque->back_block; i++) {
+        destroy_block(deque, deque->blocks[i]);
+    }
+    deque->back_block = deque->front_block;
+    deque->front_pos = deque->block_elems / 2;
+    deque->size = 0;
+}
+
+bool deque_next_segment(const Deque deque, size_t* cursor, Span* segment) {
+    size_t index = *cursor;
+    if (index >= deque->size) return false;
+
+    // 从index到所在块末尾或最后一个元素
+    size_t offset = deque->front_pos + index;
+    size_t count = deque->block_elems - (offset & (deque->block_elems - 1));
+    if (count > deque->size - index) {
+        count = deque->size - index;
+    }
+    *segment = span_make(element_at(deque, index), count, deque->elem_size);
+    *cursor = index + count;
+    return true;
+}
+
+void deque_for_each_segment(const Deque deque, DequeSegmentVisitor visitor, void* user_data) {
+    size_t cursor = 0;
+    Span segment;
+    while (deque_next_segment(deque, &cursor, &segment)) {
+        visitor(segment, user_data);
+    }
+}
+
 
 // 迭代器实现
+// node指向当前块在块数组中的位置，前后移动只在跨块时读取块数组，不做除法
+// 结束位置落在块末尾时停在该块的末尾之后，不进入未分配的下一块
 static void deque_iterator_get(Iterator it, void* dest) {
     memcpy(dest, it.ptr, it.elem_size);
 }
@@ -174,44 +257,51 @@ static void deque_iterator_set(Iterator it, const void* value) {
 
 static Iterator deque_iterator_next(Iterator it) {
     Deque deque = it.container;
-    char* ptr = it.ptr;
-    size_t offset = ((char*)ptr - (char*)deque->blocks[deque->front_block]->data) / deque->elem_size;
-    size_t block = deque->front_block + offset / BLOCK_SIZE;
+    char** node = it.node;
+    char* ptr = (char*)it.ptr + it.elem_size;
 
-    if ((offset + 1) % BLOCK_SIZE == 0) {
+    if (ptr == *node + deque->block_bytes && node < deque->blocks + deque->back_block) {
         // 移动到下一个块的开始
-        ptr = deque->blocks[block + 1]->data;
-    }
-    else {
-        ptr += deque->elem_size;
+        node++;
+        ptr = *node;
     }
     it.ptr = ptr;
+    it.node = node;
     return it;
 }
 
 static Iterator deque_iterator_prev(Iterator it) {
     Deque deque = it.container;
+    char** node = it.node;
     char* ptr = it.ptr;
-    size_t offset = ((char*)ptr - (char*)deque->blocks[deque->front_block]->data) / deque->elem_size;
-    size_t block = deque->front_block + offset / BLOCK_SIZE;
 
-    if (offset % BLOCK_SIZE == 0) {
+    if (ptr == *node && node > deque->blocks + deque->front_block) {
         // 移动到前一个块的末尾
-        ptr = (char*)deque->blocks[block - 1]->data + (BLOCK_SIZE - 1) * deque->elem_size;
-    }
-    else {
-        ptr -= deque->elem_size;
+        node--;
+        ptr = *node + deque->block_bytes;
     }
-    it.ptr = ptr;
+    it.ptr = ptr - it.elem_size;
+    it.node = node;
     return it;
 }
 
-Iterator deque_begin(Deque deque) {
+// 构造指向第index个元素的迭代器，index可以等于size
+static Iterator make_iterator(Deque deque, size_t index) {
+    size_t offset = deque->front_pos + index;
+    size_t block = offset >> deque->block_shift;
+    size_t pos = offset & (deque->block_elems - 1);
+    // 结束位置恰好在块边界时表示为上一块的末尾之后
+    if (pos == 0 && block > 0) {
+        block--;
+        pos = deque->block_elems;
+    }
+    char** node = deque->blocks + deque->front_block + block;
+
     return (Iterator) {
-        .ptr = (char*)deque->blocks[deque->front_block]->data +
-            deque->front_pos * deque->elem_size,
+        .ptr = *node + pos * deque->elem_size,
             .container = deque,
             .elem_size = deque->elem_size,
+            .node = node,
             .next = deque_iterator_next,
             .prev = deque_iterator_prev,
             .get = deque_iterator_get,
@@ -219,42 +309,26 @@ Iterator deque_begin(Deque deque) {
     };
 }
 
+// 反向迭代器交换next和prev
+static Iterator make_reverse(Iterator it) {
+    it.next = deque_iterator_prev;
+    it.prev = deque_iterator_next;
+    return it;
+}
+
+Iterator deque_begin(Deque deque) {
+    return make_iterator(deque, 0);
+}
+
 Iterator deque_end(Deque deque) {
-    return (Iterator) {
-        .ptr = (char*)deque->blocks[deque->back_block]->data +
-            deque->back_pos * deque->elem_size,
-            .container = deque,
-            .elem_size = deque->elem_size,
-            .next = deque_iterator_next,
-            .prev = deque_iterator_prev,
-            .get = deque_iterator_get,
-            .set = deque_iterator_set
-    };
+    return make_iterator(deque, deque->size);
 }
 
 Iterator deque_rbegin(Deque deque) {
-    size_t pos = deque->back_pos > 0 ? deque->back_pos - 1 : BLOCK_SIZE - 1;
-    return (Iterator) {
-        .ptr = (char*)deque->blocks[deque->back_block]->data +
-            pos * deque->elem_size,
-            .container = deque,
-            .elem_size = deque->elem_size,
-            .next = deque_iterator_prev,  // 反向时交换next和prev
-            .prev = deque_iterator_next,
-            .get = deque_iterator_get,
-            .set = deque_iterator_set
-    };
+    return make_reverse(deque_iterator_prev(make_iterator(deque, deque->size)));
 }
 
 Iterator deque_rend(Deque deque) {
-    return (Iterator) {
-        .ptr = (char*)deque->blocks[deque->front_block]->data +
-            deque->front_pos * deque->elem_size,
-            .container = deque,
-            .elem_size = deque->elem_size,
-            .next = deque_iterator_prev,  // 反向时交换next和prev
-            .prev = deque_iterator_next,
-            .get = deque_iterator_get,
-            .set = deque_iterator_set
-    };
+    // 首元素之前的位置，只用于比较
+    return make_reverse(deque_iterator_prev(make_iterator(deque, 0)));
 }
@@ -2,12 +2,24 @@
 #include <stddef.h>
 #include "alloctor/allocator.h"
 #include "iterator/iterator.h"
+#include "span.h"
 
 typedef struct Deque* Deque;
 
+// 默认每块的字节数
+#define DEQUE_DEFAULT_BLOCK_BYTES 512
+// 最多缓存的空闲块数
+#define DEQUE_SPARE_BLOCKS 4
+
+// 分段遍历回调，每次传入一段连续存放的元素
+typedef void (*DequeSegmentVisitor)(Span segment, void* user_data);
+
 // 创建deque，element_size为每个元素的字节大小，allocator为可选的分配器
 API Deque deque_create(size_t element_size, Allocator* allocator);
 
+// 指定每块的字节数创建deque，每块元素数取不超过block_bytes / element_size的2的幂（至少1个）
+API Deque deque_create_with_block_size(size_t element_size, size_t block_bytes, Allocator* allocator);
+
 // 销毁deque
 API void deque_destroy(Deque deque);
 
@@ -29,8 +41,14 @@ API void deque_front(const Deque deque,void* dest);
 // 获取尾部元素
 API void deque_back(const Deque deque,void* dest);
 
-// 设置指定位置的元素
-API void deque_set(Deque deque, int index, const void* element);
+// 获取第index个元素的地址，常数时间
+API void* deque_at(const Deque deque, size_t index);
+
+// 复制第index个元素
+API void deque_get(const Deque deque, size_t index, void* dest);
+
+// 设置第index个元素
+API void deque_set(Deque deque, size_t index, const void* element);
 
 // 获取当前大小
 API size_t deque_size(const Deque deque);
@@ -40,7 +58,16 @@ API bool deque_empty(const Deque deque);
 
 // 清空deque
 API void deque_clear(Deque deque);
-// 迭代器
+
+// 分段遍历：cursor从0开始，每次返回从cursor开始的一段连续元素，遍历完返回false
+// 每段都是普通的Span，可以直接交给span_*算法
+API bool deque_next_segment(const Deque deque, size_t* cursor, Span* segment);
+
+// 对每段连续元素调用visitor
+API void deque_for_each_segment(const Deque deque, DequeSegmentVisitor visitor, void* user_data);
+
+// 迭代器，保存当前块的位置，前后移动不做除法
+
 API Iterator deque_begin(Deque deque);
 API Iterator deque_end(Deque deque);
 API Iterator deque_rbegin(Deque deque);
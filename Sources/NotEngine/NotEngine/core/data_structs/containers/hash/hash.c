@@ -0,0 +1,128 @@
+﻿#include "hash.h"
+
+// wyhash的常量
+static const uint64_t secret[4] = {
+    0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull
+};
+
+static uint64_t read64(const uint8_t* p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint64_t read32(const uint8_t* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+// 读取1到3个字节
+static uint64_t read_small(const uint8_t* p, size_t length) {
+    return ((uint64_t)p[0] << 16) | ((uint64_t)p[length >> 1] << 8) | p[length - 1];
+}
+
+static void multiply(uint64_t* a, uint64_t* b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = (__uint128_t)*a * *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64) && !defined(__clang__)
+    *a = _umul128(*a, *b, b);
+#else
+    uint64_t ha = *a >> 32, la = (uint32_t)*a, hb = *b >> 32, lb = (uint32_t)*b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t carry = t < rl;
+    uint64_t low = t + (rm1 << 32);
+    carry += low < t;
+    *a = low;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+#endif
+}
+
+uint64_t hash_bytes(const void* data, size_t length, uint64_t seed) {
+    const uint8_t* p = data;
+    uint64_t a, b;
+    seed ^= hash_mix(seed ^ secret[0], secret[1]);
+
+    if (length <= 16) {
+        if (length >= 4) {
+            // 4到16字节：首尾各读两个可能重叠的4字节
+            size_t offset = (length >> 3) << 2;
+            a = (read32(p) << 32) | read32(p + offset);
+            b = (read32(p + length - 4) << 32) | read32(p + length - 4 - offset);
+        }
+        else if (length > 0) {
+            a = read_small(p, length);
+            b = 0;
+        }
+        else {
+            a = b = 0;
+        }
+    }
+    else {
+        size_t remaining = length;
+        if (remaining > 48) {
+            // 三条独立的混合链并行处理48字节
+            uint64_t seed1 = seed, seed2 = seed;
+            do {
+                seed = hash_mix(read64(p) ^ secret[1], read64(p + 8) ^ seed);
+                seed1 = hash_mix(read64(p + 16) ^ secret[2], read64(p + 24) ^ seed1);
+                seed2 = hash_mix(read64(p + 32) ^ secret[3], read64(p + 40) ^ seed2);
+                p += 48;
+                remaining -= 48;
+            } while (remaining > 48);
+            seed ^= seed1 ^ seed2;
+        }
+        while (remaining > 16) {
+            seed = hash_mix(read64(p) ^ secret[1], read64(p + 8) ^ seed);
+            p += 16;
+            remaining -= 16;
+        }
+        // 最后16字节可能与已处理的部分重叠
+        a = read64(p + remaining - 16);
+        b = read64(p + remaining - 8);
+    }
+
+    a ^= secret[1];
+    b ^= seed;
+    multiply(&a, &b);
+    return hash_mix(a ^ secret[0] ^ length, b ^ secret[1]);
+}
+
+uint64_t hash_string(const char* str, uint64_t seed) {
+    return hash_bytes(str, strlen(str), seed);
+}
+
+size_t hash_func_u32(const void* key) {
+    return (size_t)hash_u32(*(const uint32_t*)key, HASH_DEFAULT_SEED);
+}
+
+size_t hash_func_u64(const void* key) {
+    return (size_t)hash_u64(*(const uint64_t*)key, HASH_DEFAULT_SEED);
+}
+
+size_t hash_func_ptr(const void* key) {
+    return (size_t)hash_ptr(*(const void* const*)key, HASH_DEFAULT_SEED);
+}
+
+size_t hash_func_string(const void* key) {
+    return (size_t)hash_string(*(const char* const*)key, HASH_DEFAULT_SEED);
+}
+
+bool key_equal_u32(const void* key1, const void* key2) {
+    return *(const uint32_t*)key1 == *(const uint32_t*)key2;
+}
+
+bool key_equal_u64(const void* key1, const void* key2) {
+    return *(const uint64_t*)key1 == *(const uint64_t*)key2;
+}
+
+bool key_equal_ptr(const void* key1, const void* key2) {
+    return *(const void* const*)key1 == *(const void* const*)key2;
+}
+
+bool key_equal_string(const void* key1, const void* key2) {
+    return strcmp(*(const char* const*)key1, *(const char* const*)key2) == 0;
+}
@@ -0,0 +1,68 @@
+﻿#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "typedefs.h"
+
+#if defined(_MSC_VER) && defined(_M_X64) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+// 带种子的哈希函数族：字节序列使用wyhash风格的算法，整数和指针使用两轮128位乘法混合
+
+#define HASH_DEFAULT_SEED 0x9E3779B97F4A7C15ull
+
+// 64x64→128位乘法，返回高低两半的异或
+static inline uint64_t hash_mix(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = (__uint128_t)a * b;
+    return (uint64_t)r ^ (uint64_t)(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64) && !defined(__clang__)
+    uint64_t high;
+    uint64_t low = _umul128(a, b, &high);
+    return low ^ high;
+#else
+    uint64_t ha = a >> 32, la = (uint32_t)a, hb = b >> 32, lb = (uint32_t)b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t carry = t < rl;
+    uint64_t low = t + (rm1 << 32);
+    carry += low < t;
+    uint64_t high = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+    return low ^ high;
+#endif
+}
+
+// 64位整数哈希；单次混合时部分输入位影响不到全部输出位，所以再混合一次
+static inline uint64_t hash_u64(uint64_t value, uint64_t seed) {
+    uint64_t h = hash_mix(value ^ 0x2d358dccaa6c78a5ull, seed ^ 0x8bb84b93962eacc9ull);
+    return hash_mix(h, 0x4b33a62ed433d4a3ull);
+}
+
+// 32位整数哈希
+static inline uint64_t hash_u32(uint32_t value, uint64_t seed) {
+    return hash_u64(value, seed);
+}
+
+// 指针哈希（按地址）
+static inline uint64_t hash_ptr(const void* ptr, uint64_t seed) {
+    return hash_u64((uint64_t)(uintptr_t)ptr, seed);
+}
+
+// 字节序列哈希
+API uint64_t hash_bytes(const void* data, size_t length, uint64_t seed);
+
+// 以'\0'结尾的字符串哈希
+API uint64_t hash_string(const char* str, uint64_t seed);
+
+// 可直接传给hashmap_create的哈希和比较函数，使用默认种子
+// 字符串版本的键是const char*指针，按字符串内容哈希和比较
+API size_t hash_func_u32(const void* key);
+API size_t hash_func_u64(const void* key);
+API size_t hash_func_ptr(const void* key);
+API size_t hash_func_string(const void* key);
+API bool key_equal_u32(const void* key1, const void* key2);
+API bool key_equal_u64(const void* key1, const void* key2);
+API bool key_equal_ptr(const void* key1, const void* key2);
+API bool key_equal_string(const void* key1, const void* key2);
@@ -1,81 +1,405 @@
-﻿#include <string.h>
+﻿#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
 #include "hash_map.h"
+#include "alloctor/virtual_memory.h"
+#include "core/logger/assert.h"
 
-#define INITIAL_BUCKET_COUNT 8
-#define MAX_LOAD_FACTOR 1.0f
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
 
-// 哈希表节点
-typedef struct HashNode {
-    void* key;
-    void* value;
-    struct HashNode* next;
-} HashNode;
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HASHMAP_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+// 预取写成宏：包在函数里时GCC会把只含预取的函数当作无副作用，连同调用一起删掉
+#if defined(_MSC_VER) && !defined(__clang__)
+#define PREFETCH(addr) _mm_prefetch((const char*)(addr), _MM_HINT_T0)
+#else
+#define PREFETCH(addr) __builtin_prefetch(addr)
+#endif
+
+// Swiss table：每个槽位对应一个控制字节，按16个一组并行探测
+// 控制字节最高位为0表示占用，低7位缓存哈希值的片段（h2）；最高位为1表示空或已删除
+#define GROUP_WIDTH 16
+#define MIN_CAPACITY 16
+// 批量操作提前多少个键计算哈希并预取，需覆盖一次内存访问的延迟
+#define PREFETCH_DISTANCE 16
+
+#define CTRL_EMPTY ((int8_t)-128)   // 0b10000000
+#define CTRL_DELETED ((int8_t)-2)   // 0b11111110
+
+// 一张槽位表；增量重建期间旧表和新表同时存在
+typedef struct {
+    int8_t* ctrl;          // 控制字节，长度capacity + GROUP_WIDTH，末尾镜像前GROUP_WIDTH个字节
+    char* slots;           // 槽位数组，键和值内联存放
+    size_t capacity;       // 槽位数量，2的幂；0表示表不存在
+    size_t size;           // 表中元素数量
+    size_t growth_left;    // 不触发扩容还能占用的空槽数量
+} Table;
 
 struct HashMap {
-    HashNode** buckets;     // 桶数组
-    size_t bucket_count;    // 桶数量
-    size_t size;           // 元素数量
+    Table table;           // 当前表，新元素总是插入这里
+    Table old;             // 增量重建中尚未迁移完的旧表
+    size_t migrate_pos;    // 旧表中下一个待迁移的槽位
+    size_t migrate_step;   // 每次操作迁移的旧槽位数，0表示一次性重建
     size_t key_size;       // 键大小
     size_t value_size;     // 值大小
-    HashFunc hash_func;    // 哈希函数
-    KeyEqual key_equal;    // 键比较函数
+    size_t key_offset;     // 键在槽位中的偏移，槽位开头缓存完整哈希值
+    size_t value_offset;   // 值在槽位中的偏移
+    size_t slot_size;      // 槽位大小
+    HashFunc hash_func;    // 哈希函数，NULL表示按字节哈希整个键
+    bool mix_hash;         // 是否对hash_func的结果再做一次混合
+    KeyEqual key_equal;    // 键比较函数，NULL表示按字节比较
     Allocator* allocator;  // 内存分配器
+    const void* mapping;   // 快照的只读文件映射，NULL表示普通的可修改表
+    size_t mapping_size;   // 映射大小
 };
 
-// 创建新节点
-static HashNode* create_node(HashMap map, const void* key, const void* value) {
-    HashNode* node = map->allocator->allocate(sizeof(HashNode));
-    node->key = map->allocator->allocate(map->key_size);
-    node->value = map->allocator->allocate(map->value_size);
-    node->next = NULL;
+typedef uint32_t GroupMask;
+
+static uint32_t lowest_bit_index(GroupMask mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (uint32_t)index;
+#else
+    return (uint32_t)__builtin_ctz(mask);
+#endif
+}
+
+static uint32_t highest_bit_index(GroupMask mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanReverse(&index, mask);
+    return (uint32_t)index;
+#else
+    return 31u - (uint32_t)__builtin_clz(mask);
+#endif
+}
+
+// 组内匹配：返回第i位为1表示组内第i个控制字节满足条件
+#ifdef HASHMAP_USE_SSE2
+static GroupMask group_match(const int8_t* group, int8_t h2) {
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+    return (GroupMask)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl));
+}
+
+static GroupMask group_match_empty(const int8_t* group) {
+    return group_match(group, CTRL_EMPTY);
+}
+
+static GroupMask group_match_empty_or_deleted(const int8_t* group) {
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+    return (GroupMask)_mm_movemask_epi8(ctrl);
+}
+#else
+static GroupMask group_match(const int8_t* group, int8_t h2) {
+    GroupMask mask = 0;
+    for (uint32_t i = 0; i < GROUP_WIDTH; i++) {
+        mask |= (GroupMask)(group[i] == h2) << i;
+    }
+    return mask;
+}
+
+static GroupMask group_match_empty(const int8_t* group) {
+    return group_match(group, CTRL_EMPTY);
+}
+
+static GroupMask group_match_empty_or_deleted(const int8_t* group) {
+    GroupMask mask = 0;
+    for (uint32_t i = 0; i < GROUP_WIDTH; i++) {
+        mask |= (GroupMask)(group[i] < 0) << i;
+    }
+    return mask;
+}
+#endif
+
+static size_t hash_h1(size_t hash) {
+    return hash >> 7;
+}
+
+static int8_t hash_h2(size_t hash) {
+    return (int8_t)(hash & 0x7F);
+}
 
-    memcpy(node->key, key, map->key_size);
-    memcpy(node->value, value, map->value_size);
-    return node;
+// 最大负载因子7/8
+static size_t capacity_to_growth(size_t capacity) {
+    return capacity - capacity / 8;
 }
 
-// 销毁节点
-static void destroy_node(HashMap map, HashNode* node) {
-    map->allocator->deallocate(node->key);
-    map->allocator->deallocate(node->value);
-    map->allocator->deallocate(node);
+static size_t round_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// 按大小推断的自然对齐，不超过默认对齐
+static size_t natural_alignment(size_t size) {
+    size_t alignment = size & (~size + 1);
+    if (alignment == 0 || alignment > ALLOCATOR_DEFAULT_ALIGNMENT) {
+        alignment = ALLOCATOR_DEFAULT_ALIGNMENT;
+    }
+    return alignment;
 }
 
-// 查找节点
-static HashNode** find_node(const HashMap map, const void* key) {
-    size_t hash = map->hash_func(key);
-    size_t bucket = hash % map->bucket_count;
-    HashNode** curr = &map->buckets[bucket];
+static char* slot_at(const HashMap map, const Table* table, size_t index) {
+    return table->slots + index * map->slot_size;
+}
+
+static size_t slot_hash(const HashMap map, const Table* table, size_t index) {
+    return *(const size_t*)slot_at(map, table, index);
+}
+
+static void* slot_key(const HashMap map, const Table* table, size_t index) {
+    return slot_at(map, table, index) + map->key_offset;
+}
+
+static void* slot_value(const HashMap map, const Table* table, size_t index) {
+    return slot_at(map, table, index) + map->value_offset;
+}
+
+// 内置哈希的输出已经充分混合；用户哈希常常是恒等函数，h1取高位时连续的键会落在同一探测起点
+static bool needs_mixing(HashFunc hash_func) {
+    return hash_func && hash_func != hash_func_u32 && hash_func != hash_func_u64
+        && hash_func != hash_func_ptr && hash_func != hash_func_string;
+}
 
-    while (*curr) {
-        if (map->key_equal((*curr)->key, key)) {
-            return curr;
+static size_t map_hash(const HashMap map, const void* key) {
+    if (map->hash_func) {
+        size_t hash = map->hash_func(key);
+        // 128位乘法后高低两半异或，每个输入位都能影响h1和h2
+        return map->mix_hash ? (size_t)hash_mix(hash, HASH_DEFAULT_SEED) : hash;
+    }
+    return (size_t)hash_bytes(key, map->key_size, HASH_DEFAULT_SEED);
+}
+
+static bool map_key_equal(const HashMap map, const void* key1, const void* key2) {
+    if (map->key_equal) {
+        return map->key_equal(key1, key2);
+    }
+    return memcmp(key1, key2, map->key_size) == 0;
+}
+
+// 设置控制字节，同时更新末尾的镜像
+static void set_ctrl(Table* table, size_t index, int8_t value) {
+    size_t mask = table->capacity - 1;
+    table->ctrl[index] = value;
+    table->ctrl[((index - GROUP_WIDTH) & mask) + GROUP_WIDTH] = value;
+}
+
+static void allocate_table(HashMap map, Table* table, size_t capacity) {
+    table->capacity = capacity;
+    table->ctrl = allocator_allocate(map->allocator, capacity + GROUP_WIDTH);
+    memset(table->ctrl, (unsigned char)CTRL_EMPTY, capacity + GROUP_WIDTH);
+    table->slots = allocator_allocate(map->allocator, capacity * map->slot_size);
+    table->size = 0;
+    table->growth_left = capacity_to_growth(capacity);
+}
+
+static void free_table(HashMap map, Table* table) {
+    // 快照的表指向文件映射，由hashmap_destroy统一解除映射
+    if (table->capacity == 0 || map->mapping) return;
+    allocator_deallocate(map->allocator, table->ctrl, table->capacity + GROUP_WIDTH);
+    allocator_deallocate(map->allocator, table->slots, table->capacity * map->slot_size);
+    memset(table, 0, sizeof(Table));
+}
+
+// 查找键所在的槽位，找不到返回capacity
+static size_t find_slot(const HashMap map, const Table* table, const void* key, size_t hash) {
+    size_t mask = table->capacity - 1;
+    size_t pos = hash_h1(hash) & mask;
+    size_t step = 0;
+    int8_t h2 = hash_h2(hash);
+
+    for (;;) {
+        const int8_t* group = table->ctrl + pos;
+        GroupMask match = group_match(group, h2);
+        while (match) {
+            size_t index = (pos + lowest_bit_index(match)) & mask;
+            // 先比较缓存的完整哈希值，只有相同时才比较键
+            if (slot_hash(map, table, index) == hash &&
+                map_key_equal(map, slot_key(map, table, index), key)) {
+                return index;
+            }
+            match &= match - 1;
         }
-        curr = &(*curr)->next;
+        if (group_match_empty(group)) {
+            return table->capacity;
+        }
+        // 按组做三角探测，容量为2的幂时可遍历所有组
+        step += GROUP_WIDTH;
+        pos = (pos + step) & mask;
     }
-    return curr;
 }
 
-// 重新哈希
-static void rehash_internal(HashMap map, size_t new_count) {
-    HashNode** new_buckets = map->allocator->allocate(sizeof(HashNode*) * new_count);
-    memset(new_buckets, 0, sizeof(HashNode*) * new_count);
+// 查找哈希值探测序列上第一个空或已删除的槽位
+static size_t find_insert_slot(const Table* table, size_t hash) {
+    size_t mask = table->capacity - 1;
+    size_t pos = hash_h1(hash) & mask;
+    size_t step = 0;
 
-    // 重新分配所有节点
-    for (size_t i = 0; i < map->bucket_count; i++) {
-        HashNode* curr = map->buckets[i];
-        while (curr) {
-            HashNode* next = curr->next;
-            size_t new_bucket = map->hash_func(curr->key) % new_count;
-            curr->next = new_buckets[new_bucket];
-            new_buckets[new_bucket] = curr;
-            curr = next;
+    for (;;) {
+        GroupMask match = group_match_empty_or_deleted(table->ctrl + pos);
+        if (match) {
+            return (pos + lowest_bit_index(match)) & mask;
         }
+        step += GROUP_WIDTH;
+        pos = (pos + step) & mask;
     }
+}
 
-    map->allocator->deallocate(map->buckets);
-    map->buckets = new_buckets;
-    map->bucket_count = new_count;
+// 把一个已知不存在于表中的槽位内容放入表
+static void table_insert_slot(HashMap map, Table* table, size_t hash, const void* slot) {
+    size_t index = find_insert_slot(table, hash);
+    if (table->ctrl[index] == CTRL_EMPTY) {
+        table->growth_left--;
+    }
+    set_ctrl(table, index, hash_h2(hash));
+    memcpy(slot_at(map, table, index), slot, map->slot_size);
+    table->size++;
+}
+
+static void rehash_and_grow(HashMap map);
+
+// 从旧表迁移最多count个槽位，旧表迁移完后释放
+static void migrate(HashMap map, size_t count) {
+    Table* old = &map->old;
+    size_t end = old->capacity - map->migrate_pos > count ? map->migrate_pos + count : old->capacity;
+
+    for (size_t i = map->migrate_pos; i < end; i++) {
+        if (old->ctrl[i] < 0) continue;
+
+        // 迁移完成前新表已被插入占满，改为一次性重建
+        if (map->table.growth_left == 0) {
+            rehash_and_grow(map);
+            return;
+        }
+
+        // 使用缓存的哈希值，迁移时不重新计算
+        const char* slot = slot_at(map, old, i);
+        table_insert_slot(map, &map->table, slot_hash(map, old, i), slot);
+        // 标记为已删除，避免旧表查找命中已迁移的副本
+        set_ctrl(old, i, CTRL_DELETED);
+        old->size--;
+    }
+
+    map->migrate_pos = end;
+    if (end == old->capacity || old->size == 0) {
+        free_table(map, old);
+    }
+}
+
+static void finish_migration(HashMap map) {
+    if (map->old.capacity) {
+        migrate(map, map->old.capacity);
+    }
+}
+
+// 每次操作推进一步增量重建
+static void migrate_one_step(HashMap map) {
+    if (map->old.capacity) {
+        migrate(map, map->migrate_step);
+    }
+}
+
+// 把表中的全部元素放入当前表
+static void move_slots(HashMap map, const Table* from) {
+    for (size_t i = 0; i < from->capacity; i++) {
+        if (from->ctrl[i] >= 0) {
+            table_insert_slot(map, &map->table, slot_hash(map, from, i), slot_at(map, from, i));
+        }
+    }
+}
+
+// 一次性把当前表和旧表的全部元素放入新容量的表
+static void rebuild(HashMap map, size_t new_capacity) {
+    if (map->mapping) return;
+    Table previous = map->table;
+    allocate_table(map, &map->table, new_capacity);
+    move_slots(map, &previous);
+    free_table(map, &previous);
+
+    if (map->old.capacity) {
+        move_slots(map, &map->old);
+        free_table(map, &map->old);
+    }
+}
+
+// 换用新容量的表：增量模式下保留旧表逐步迁移，否则立即迁移全部元素
+// 已有旧表时总是一次性重建，保证同一时刻最多两张表
+static void resize(HashMap map, size_t new_capacity) {
+    if (map->migrate_step == 0 || map->old.capacity) {
+        rebuild(map, new_capacity);
+        return;
+    }
+
+    map->old = map->table;
+    map->migrate_pos = 0;
+    allocate_table(map, &map->table, new_capacity);
+    migrate(map, map->migrate_step);
+}
+
+// 没有可用空槽时调用：删除标记过多则原容量重建，否则容量翻倍
+static void rehash_and_grow(HashMap map) {
+    Table* table = &map->table;
+    if (table->size + map->old.size <= capacity_to_growth(table->capacity) / 2) {
+        resize(map, table->capacity);
+    }
+    else {
+        resize(map, table->capacity * 2);
+    }
+}
+
+// 容纳count个元素所需的最小容量
+static size_t capacity_for(size_t count) {
+    size_t capacity = MIN_CAPACITY;
+    while (capacity_to_growth(capacity) < count) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+// 在当前表和旧表中查找，找到时table_out指向所在的表
+static size_t lookup(const HashMap map, const void* key, size_t hash, Table** table_out) {
+    size_t index = find_slot(map, &map->table, key, hash);
+    if (index != map->table.capacity) {
+        *table_out = &map->table;
+        return index;
+    }
+    if (map->old.size) {
+        index = find_slot(map, &map->old, key, hash);
+        if (index != map->old.capacity) {
+            *table_out = &map->old;
+            return index;
+        }
+    }
+    *table_out = NULL;
+    return 0;
+}
+
+// 按键和值的大小计算槽位布局，快照按同样的布局校验
+static void init_layout(HashMap map, size_t key_size, size_t value_size) {
+    size_t key_alignment = natural_alignment(key_size);
+    size_t value_alignment = natural_alignment(value_size);
+    size_t slot_alignment = key_alignment > value_alignment ? key_alignment : value_alignment;
+
+    map->key_size = key_size;
+    map->value_size = value_size;
+    if (slot_alignment < sizeof(size_t)) {
+        slot_alignment = sizeof(size_t);
+    }
+
+    map->key_offset = round_up(sizeof(size_t), key_alignment);
+    map->value_offset = round_up(map->key_offset + key_size, value_alignment);
+    map->slot_size = round_up(map->value_offset + value_size, slot_alignment);
 }
 
 HashMap hashmap_create(size_t key_size, size_t value_size,
@@ -83,132 +407,763 @@ HashMap hashmap_create(size_t key_size, size_t value_size,
     Allocator* allocator) {
     if (!allocator) allocator = get_default_allocator();
 
-    HashMap map = allocator->allocate(sizeof(struct HashMap));
-    map->bucket_count = INITIAL_BUCKET_COUNT;
-    map->buckets = allocator->allocate(sizeof(HashNode*) * INITIAL_BUCKET_COUNT);
-    memset(map->buckets, 0, sizeof(HashNode*) * INITIAL_BUCKET_COUNT);
-
-    map->size = 0;
-    map->key_size = key_size;
-    map->value_size = value_size;
+    HashMap map = allocator_allocate(allocator, sizeof(struct HashMap));
+    memset(map, 0, sizeof(struct HashMap));
+    init_layout(map, key_size, value_size);
     map->hash_func = hash_func;
+    map->mix_hash = needs_mixing(hash_func);
     map->key_equal = key_equal;
     map->allocator = allocator;
+    allocate_table(map, &map->table, MIN_CAPACITY);
 
     return map;
 }
 
+HashMap hashmap_create_u32(size_t value_size, Allocator* allocator) {
+    return hashmap_create(sizeof(uint32_t), value_size, hash_func_u32, key_equal_u32, allocator);
+}
+
+HashMap hashmap_create_u64(size_t value_size, Allocator* allocator) {
+    return hashmap_create(sizeof(uint64_t), value_size, hash_func_u64, key_equal_u64, allocator);
+}
+
+HashMap hashmap_create_bytes(size_t key_size, size_t value_size, Allocator* allocator) {
+    return hashmap_create(key_size, value_size, NULL, NULL, allocator);
+}
+
 void hashmap_destroy(HashMap map) {
-    hashmap_clear(map);
-    map->allocator->deallocate(map->buckets);
-    map->allocator->deallocate(map);
+    if (map->mapping) {
+        vm_unmap_file(map->mapping, map->mapping_size);
+        allocator_deallocate(map->allocator, map, sizeof(struct HashMap));
+        return;
+    }
+    free_table(map, &map->table);
+    free_table(map, &map->old);
+    allocator_deallocate(map->allocator, map, sizeof(struct HashMap));
 }
 
-bool hashmap_insert(HashMap map, const void* key, const void* value) {
-    if (hashmap_load_factor(map) >= MAX_LOAD_FACTOR) {
-        rehash_internal(map, map->bucket_count * 2);
+// 快照映射的是只读内存，修改操作记录错误后直接返回
+static bool check_writable(const HashMap map, const char* operation) {
+    if (!map->mapping) return true;
+    LOG_ERROR("%s on a read-only HashMap snapshot", operation);
+    return false;
+}
+
+void hashmap_set_incremental_rehash(HashMap map, size_t step) {
+    map->migrate_step = step;
+    if (step == 0) {
+        finish_migration(map);
     }
+}
 
-    HashNode** node = find_node(map, key);
-    if (*node) {
-        // 更新已存在的值
-        memcpy((*node)->value, value, map->value_size);
-        return false;
+size_t hashmap_hash_key(const HashMap map, const void* key) {
+    return map_hash(map, key);
+}
+
+void* hashmap_find_hashed(const HashMap map, const void* key, size_t hash) {
+    migrate_one_step(map);
+
+    Table* found;
+    size_t index = lookup(map, key, hash, &found);
+    return found ? slot_value(map, found, index) : NULL;
+}
+
+void* hashmap_emplace_hashed(HashMap map, const void* key, size_t hash, bool* inserted) {
+    *inserted = false;
+    if (!check_writable(map, "hashmap_emplace_hashed")) return NULL;
+    migrate_one_step(map);
+
+    Table* found;
+    size_t index = lookup(map, key, hash, &found);
+    if (found) {
+        // 旧表中的元素原地返回，等待迁移
+        *inserted = false;
+        return slot_value(map, found, index);
     }
 
-    // 插入新节点
-    *node = create_node(map, key, value);
-    map->size++;
-    return true;
+    Table* table = &map->table;
+    index = find_insert_slot(table, hash);
+    if (table->growth_left == 0 && table->ctrl[index] != CTRL_DELETED) {
+        rehash_and_grow(map);
+        index = find_insert_slot(table, hash);
+    }
+
+    // 复用删除标记不消耗空槽
+    if (table->ctrl[index] == CTRL_EMPTY) {
+        table->growth_left--;
+    }
+    set_ctrl(table, index, hash_h2(hash));
+    *(size_t*)slot_at(map, table, index) = hash;
+    memcpy(slot_key(map, table, index), key, map->key_size);
+    table->size++;
+    *inserted = true;
+    return slot_value(map, table, index);
+}
+
+size_t hashmap_erase_hashed(HashMap map, const void* key, size_t hash) {
+    if (!check_writable(map, "hashmap_erase")) return 0;
+    migrate_one_step(map);
+
+    Table* table;
+    size_t index = lookup(map, key, hash, &table);
+    if (!table) return 0;
+
+    // 槽位前后都有空位、且两侧连续非空的长度不足一组时，没有探测序列会越过它，可以直接置空
+    size_t mask = table->capacity - 1;
+    GroupMask empty_before = group_match_empty(table->ctrl + ((index - GROUP_WIDTH) & mask));
+    GroupMask empty_after = group_match_empty(table->ctrl + index);
+    bool was_never_full = empty_before && empty_after &&
+        lowest_bit_index(empty_after) + (GROUP_WIDTH - 1 - highest_bit_index(empty_before)) < GROUP_WIDTH;
+
+    if (was_never_full) {
+        set_ctrl(table, index, CTRL_EMPTY);
+        table->growth_left++;
+    }
+    else {
+        set_ctrl(table, index, CTRL_DELETED);
+    }
+    table->size--;
+    return 1;
+}
+
+bool hashmap_insert(HashMap map, const void* key, const void* value) {
+    bool inserted;
+    void* dest = hashmap_emplace_hashed(map, key, map_hash(map, key), &inserted);
+    if (!dest) return false;
+    memcpy(dest, value, map->value_size);
+    return inserted;
 }
 
 bool hashmap_get(const HashMap map, const void* key, void* value_out) {
-    HashNode** node = find_node(map, key);
-    if (!*node) return false;
+    void* value = hashmap_find_hashed(map, key, map_hash(map, key));
+    if (!value) return false;
 
     if (value_out) {
-        memcpy(value_out, (*node)->value, map->value_size);
+        memcpy(value_out, value, map->value_size);
     }
     return true;
 }
 
 size_t hashmap_erase(HashMap map, const void* key) {
-    HashNode** node = find_node(map, key);
-    if (!*node) return 0;
-
-    HashNode* temp = *node;
-    *node = (*node)->next;
-    destroy_node(map, temp);
-    map->size--;
-    return 1;
+    return hashmap_erase_hashed(map, key, map_hash(map, key));
 }
 
 void hashmap_clear(HashMap map) {
-    for (size_t i = 0; i < map->bucket_count; i++) {
-        HashNode* curr = map->buckets[i];
-        while (curr) {
-            HashNode* next = curr->next;
-            destroy_node(map, curr);
-            curr = next;
-        }
-        map->buckets[i] = NULL;
-    }
-    map->size = 0;
+    if (!check_writable(map, "hashmap_clear")) return;
+    free_table(map, &map->old);
+    Table* table = &map->table;
+    memset(table->ctrl, (unsigned char)CTRL_EMPTY, table->capacity + GROUP_WIDTH);
+    table->size = 0;
+    table->growth_left = capacity_to_growth(table->capacity);
 }
 
 size_t hashmap_size(const HashMap map) {
-    return map->size;
+    return map->table.size + map->old.size;
 }
 
 size_t hashmap_bucket_count(const HashMap map) {
-    return map->bucket_count;
+    return map->table.capacity;
 }
 
 float hashmap_load_factor(const HashMap map) {
-    return (float)map->size / map->bucket_count;
+    return (float)hashmap_size(map) / map->table.capacity;
 }
 
 void hashmap_rehash(HashMap map, size_t bucket_count) {
-    if (bucket_count > 0) {
-        rehash_internal(map, bucket_count);
+    if (!check_writable(map, "hashmap_rehash")) return;
+
+    // 显式重建总是一次完成；桶数量向上取整为2的幂，且至少能容纳现有元素
+    size_t capacity = capacity_for(hashmap_size(map));
+    while (capacity < bucket_count) {
+        capacity *= 2;
     }
+    rebuild(map, capacity);
 }
 
 bool hashmap_empty(const HashMap map) {
-    return map->size == 0;
+    return hashmap_size(map) == 0;
 }
 
 bool hashmap_contains(const HashMap map, const void* key) {
-    HashNode** node = find_node(map, key);
-    return *node != NULL;
+    return hashmap_find_hashed(map, key, map_hash(map, key)) != NULL;
 }
 
-ArrayList hashmap_keys(HashMap map) {
-    ArrayList keys = arraylist_create(map->key_size, map->allocator);
+void hashmap_reserve(HashMap map, size_t count) {
+    if (!check_writable(map, "hashmap_reserve")) return;
+
+    size_t size = hashmap_size(map);
+    if (count < size) count = size;
+
+    // 删除标记占用的空槽也计入，保证之后插入到count个元素前不再重建
+    if (map->old.capacity == 0 && map->table.growth_left >= count - size) return;
+
+    size_t capacity = capacity_for(count);
+    if (capacity < map->table.capacity) {
+        capacity = map->table.capacity;
+    }
+    rebuild(map, capacity);
+}
 
-    // 遍历所有桶和链表节点
-    for (size_t i = 0; i < map->bucket_count; i++) {
-        HashNode* curr = map->buckets[i];
-        while (curr) {
-            arraylist_push_back(keys, curr->key);
-            curr = curr->next;
+// 批量操作的流水线：处理第i个键时，第i + PREFETCH_DISTANCE个键的哈希已算好，
+// 并已预取其探测序列的第一组控制字节和对应槽位
+static void pipeline_push(const HashMap map, const char* keys, size_t i, size_t* ring) {
+    const Table* table = &map->table;
+    size_t hash = map_hash(map, keys + i * map->key_size);
+    size_t pos = hash_h1(hash) & (table->capacity - 1);
+    PREFETCH(table->ctrl + pos);
+    PREFETCH(slot_at(map, table, pos));
+    ring[i % PREFETCH_DISTANCE] = hash;
+}
+
+static void pipeline_start(const HashMap map, const char* keys, size_t count, size_t* ring) {
+    for (size_t i = 0; i < count && i < PREFETCH_DISTANCE; i++) {
+        pipeline_push(map, keys, i, ring);
+    }
+}
+
+// 取出第i个键的哈希，同时为后面的键发出预取
+static size_t pipeline_pop(const HashMap map, const char* keys, size_t count, size_t i, size_t* ring) {
+    size_t hash = ring[i % PREFETCH_DISTANCE];
+    if (i + PREFETCH_DISTANCE < count) {
+        pipeline_push(map, keys, i + PREFETCH_DISTANCE, ring);
+    }
+    return hash;
+}
+
+size_t hashmap_insert_batch(HashMap map, const void* keys, const void* values, size_t count) {
+    if (!check_writable(map, "hashmap_insert_batch")) return 0;
+    hashmap_reserve(map, hashmap_size(map) + count);
+
+    const char* key = keys;
+    const char* value = values;
+    size_t ring[PREFETCH_DISTANCE];
+    size_t inserted_count = 0;
+
+    pipeline_start(map, key, count, ring);
+    for (size_t i = 0; i < count; i++) {
+        size_t hash = pipeline_pop(map, key, count, i, ring);
+        bool inserted;
+        void* dest = hashmap_emplace_hashed(map, key + i * map->key_size, hash, &inserted);
+        memcpy(dest, value + i * map->value_size, map->value_size);
+        inserted_count += inserted;
+    }
+    return inserted_count;
+}
+
+size_t hashmap_get_batch(const HashMap map, const void* keys, size_t count, void* values_out, bool* found_out) {
+    const char* key = keys;
+    char* value_out = values_out;
+    size_t ring[PREFETCH_DISTANCE];
+    size_t found_count = 0;
+
+    pipeline_start(map, key, count, ring);
+    for (size_t i = 0; i < count; i++) {
+        size_t hash = pipeline_pop(map, key, count, i, ring);
+        void* value = hashmap_find_hashed(map, key + i * map->key_size, hash);
+        if (value && value_out) {
+            memcpy(value_out + i * map->value_size, value, map->value_size);
+        }
+        if (found_out) {
+            found_out[i] = value != NULL;
+        }
+        found_count += value != NULL;
+    }
+    return found_count;
+}
+
+// 遍历位置：[0, table.capacity)对应当前表的槽位，其后对应旧表的槽位
+
+// 在表的[index, end)中查找第一个占用的槽位，按组扫描控制字节，找不到返回end
+static size_t table_next_full(const Table* table, size_t index, size_t end) {
+    while (index < end) {
+        GroupMask full = ~group_match_empty_or_deleted(table->ctrl + index) & 0xFFFF;
+        if (end - index < GROUP_WIDTH) {
+            full &= ((GroupMask)1 << (end - index)) - 1;
+        }
+        if (full) {
+            return index + lowest_bit_index(full);
         }
+        index += GROUP_WIDTH;
+    }
+    return end;
+}
+
+// 在遍历位置[cursor, end)中查找第一个占用的槽位，找不到返回end
+static size_t next_full(const HashMap map, size_t cursor, size_t end) {
+    size_t table_end = map->table.capacity;
+    if (cursor < table_end) {
+        size_t limit = end < table_end ? end : table_end;
+        size_t found = table_next_full(&map->table, cursor, limit);
+        if (found < limit) return found;
+        cursor = limit;
     }
+    if (cursor < end) {
+        return table_end + table_next_full(&map->old, cursor - table_end, end - table_end);
+    }
+    return end;
+}
+
+static char* cursor_slot(const HashMap map, size_t cursor) {
+    if (cursor < map->table.capacity) {
+        return slot_at(map, &map->table, cursor);
+    }
+    return slot_at(map, &map->old, cursor - map->table.capacity);
+}
 
+static bool cursor_full(const HashMap map, size_t cursor) {
+    if (cursor < map->table.capacity) {
+        return map->table.ctrl[cursor] >= 0;
+    }
+    return map->old.ctrl[cursor - map->table.capacity] >= 0;
+}
+
+// 由槽位地址反推遍历位置
+static size_t slot_cursor(const HashMap map, const char* slot) {
+    const Table* table = &map->table;
+    if (slot >= table->slots && slot < table->slots + table->capacity * map->slot_size) {
+        return (size_t)(slot - table->slots) / map->slot_size;
+    }
+    return table->capacity + (size_t)(slot - map->old.slots) / map->slot_size;
+}
+
+size_t hashmap_slot_count(const HashMap map) {
+    return map->table.capacity + map->old.capacity;
+}
+
+bool hashmap_next(const HashMap map, size_t* cursor, HashMapPair* pair) {
+    size_t end = hashmap_slot_count(map);
+    size_t found = next_full(map, *cursor, end);
+    if (found == end) {
+        *cursor = end;
+        return false;
+    }
+
+    char* slot = cursor_slot(map, found);
+    pair->key = slot + map->key_offset;
+    pair->value = slot + map->value_offset;
+    *cursor = found + 1;
+    return true;
+}
+
+void hashmap_for_each_range(const HashMap map, size_t begin, size_t end,
+    HashMapVisitor visitor, void* user_data) {
+    size_t slot_count = hashmap_slot_count(map);
+    if (end > slot_count) end = slot_count;
+
+    for (size_t cursor = next_full(map, begin, end); cursor < end; cursor = next_full(map, cursor + 1, end)) {
+        char* slot = cursor_slot(map, cursor);
+        visitor(slot + map->key_offset, slot + map->value_offset, user_data);
+    }
+}
+
+void hashmap_for_each(const HashMap map, HashMapVisitor visitor, void* user_data) {
+    hashmap_for_each_range(map, 0, hashmap_slot_count(map), visitor, user_data);
+}
+
+// 并行遍历：各线程从共享计数器领取固定大小的区间，快的线程多领，负载自动均衡
+#define PARALLEL_CHUNK_SLOTS 16384
+#define PARALLEL_MAX_THREADS 64
+
+typedef struct {
+    HashMap map;
+    HashMapVisitor visitor;
+    void* user_data;
+    size_t slot_count;
+    atomic_size_t next_chunk;
+} ParallelJob;
+
+static void parallel_worker(ParallelJob* job) {
+    for (;;) {
+        size_t begin = atomic_fetch_add(&job->next_chunk, 1) * PARALLEL_CHUNK_SLOTS;
+        if (begin >= job->slot_count) break;
+        hashmap_for_each_range(job->map, begin, begin + PARALLEL_CHUNK_SLOTS, job->visitor, job->user_data);
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI parallel_thread(LPVOID arg) {
+    parallel_worker(arg);
+    return 0;
+}
+#else
+static void* parallel_thread(void* arg) {
+    parallel_worker(arg);
+    return NULL;
+}
+#endif
+
+static size_t cpu_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (size_t)count : 1;
+#endif
+}
+
+void hashmap_parallel_for_each(const HashMap map, HashMapVisitor visitor, void* user_data, size_t thread_count) {
+    size_t slot_count = hashmap_slot_count(map);
+    size_t chunk_count = (slot_count + PARALLEL_CHUNK_SLOTS - 1) / PARALLEL_CHUNK_SLOTS;
+    if (thread_count == 0) thread_count = cpu_count();
+    if (thread_count > chunk_count) thread_count = chunk_count;
+    if (thread_count > PARALLEL_MAX_THREADS) thread_count = PARALLEL_MAX_THREADS;
+
+    // 只有一个区间或单线程时直接在调用线程上遍历
+    if (thread_count <= 1) {
+        hashmap_for_each(map, visitor, user_data);
+        return;
+    }
+
+    ParallelJob job = { .map = map, .visitor = visitor, .user_data = user_data, .slot_count = slot_count };
+    atomic_init(&job.next_chunk, 0);
+
+    // 调用线程也参与遍历，额外创建thread_count - 1个线程；创建失败的部分由其余线程分担
+#ifdef _WIN32
+    HANDLE threads[PARALLEL_MAX_THREADS];
+    size_t started = 0;
+    for (size_t i = 1; i < thread_count; i++) {
+        HANDLE thread = CreateThread(NULL, 0, parallel_thread, &job, 0, NULL);
+        if (thread) threads[started++] = thread;
+    }
+    parallel_worker(&job);
+    for (size_t i = 0; i < started; i++) {
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+    }
+#else
+    pthread_t threads[PARALLEL_MAX_THREADS];
+    size_t started = 0;
+    for (size_t i = 1; i < thread_count; i++) {
+        if (pthread_create(&threads[started], NULL, parallel_thread, &job) == 0) started++;
+    }
+    parallel_worker(&job);
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+#endif
+}
+
+// 迭代器：ptr指向槽位，end为NULL；get/set操作值
+static Iterator map_iterator_next(Iterator it) {
+    HashMap map = it.container;
+    if (it.ptr) {
+        size_t end = hashmap_slot_count(map);
+        size_t found = next_full(map, slot_cursor(map, it.ptr) + 1, end);
+        it.ptr = found < end ? cursor_slot(map, found) : NULL;
+    }
+    return it;
+}
+
+static Iterator map_iterator_prev(Iterator it) {
+    HashMap map = it.container;
+    size_t cursor = it.ptr ? slot_cursor(map, it.ptr) : hashmap_slot_count(map);
+    while (cursor > 0) {
+        cursor--;
+        if (cursor_full(map, cursor)) {
+            it.ptr = cursor_slot(map, cursor);
+            return it;
+        }
+    }
+    return it;
+}
+
+static void map_iterator_get(Iterator it, void* dest) {
+    HashMap map = it.container;
+    if (it.ptr) {
+        memcpy(dest, (char*)it.ptr + map->value_offset, it.elem_size);
+    }
+}
+
+static void map_iterator_set(Iterator it, const void* value) {
+    HashMap map = it.container;
+    if (it.ptr && check_writable(map, "iterator_set")) {
+        memcpy((char*)it.ptr + map->value_offset, value, it.elem_size);
+    }
+}
+
+static Iterator make_iterator(HashMap map, void* slot) {
+    return (Iterator) {
+        .ptr = slot,
+            .container = map,
+            .elem_size = map->value_size,
+            .next = map_iterator_next,
+            .prev = map_iterator_prev,
+            .get = map_iterator_get,
+            .set = map_iterator_set
+    };
+}
+
+Iterator hashmap_begin(HashMap map) {
+    size_t end = hashmap_slot_count(map);
+    size_t found = next_full(map, 0, end);
+    return make_iterator(map, found < end ? cursor_slot(map, found) : NULL);
+}
+
+Iterator hashmap_end(HashMap map) {
+    return make_iterator(map, NULL);
+}
+
+HashMapPair hashmap_iterator_pair(Iterator it) {
+    HashMap map = it.container;
+    HashMapPair pair = { NULL, NULL };
+    if (it.ptr) {
+        pair.key = (char*)it.ptr + map->key_offset;
+        pair.value = (char*)it.ptr + map->value_offset;
+    }
+    return pair;
+}
+
+void hashmap_get_pair(Iterator it, void* key, void* value) {
+    HashMap map = it.container;
+    HashMapPair pair = hashmap_iterator_pair(it);
+    if (!pair.key) return;
+
+    if (key) memcpy(key, pair.key, map->key_size);
+    if (value) memcpy(value, pair.value, map->value_size);
+}
+
+// 把所有占用槽位的键或值追加到列表
+static void collect_slots(const HashMap map, ArrayList list, size_t offset) {
+    size_t end = hashmap_slot_count(map);
+    for (size_t cursor = next_full(map, 0, end); cursor < end; cursor = next_full(map, cursor + 1, end)) {
+        arraylist_push_back(list, cursor_slot(map, cursor) + offset);
+    }
+}
+
+ArrayList hashmap_keys(HashMap map) {
+    ArrayList keys = arraylist_create(map->key_size, map->allocator);
+    arraylist_reserve(keys, hashmap_size(map));
+    collect_slots(map, keys, map->key_offset);
     return keys;
 }
 
 ArrayList hashmap_values(HashMap map) {
     ArrayList values = arraylist_create(map->value_size, map->allocator);
+    arraylist_reserve(values, hashmap_size(map));
+    collect_slots(map, values, map->value_offset);
+    return values;
+}
+
+// 快照文件：头部之后依次是控制字节和槽位数组，与内存中的表布局相同，映射后可以原地查询
+// 偏移都相对文件开头，各段按SNAPSHOT_ALIGNMENT对齐，映射地址按页对齐，因此槽位对齐保持不变
+#define SNAPSHOT_MAGIC 0x4D48454Eu    // "NEHM"，字节序不同时读出的值不同
+// 版本2：校验和覆盖头部字段，自定义哈希经过混合后缓存
+#define SNAPSHOT_VERSION 2
+#define SNAPSHOT_ALIGNMENT 64
+// 校验和按块链式计算：每块的哈希以前一块的结果为种子
+#define SNAPSHOT_CHUNK (64 * 1024)
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t word_size;       // sizeof(size_t)，槽位中缓存的哈希值宽度
+    uint64_t key_size;
+    uint64_t value_size;
+    uint64_t key_offset;
+    uint64_t value_offset;
+    uint64_t slot_size;
+    uint64_t capacity;
+    uint64_t size;
+    uint64_t ctrl_offset;
+    uint64_t slots_offset;
+    uint64_t file_size;
+    uint64_t checksum;        // 头部其余字段和[ctrl_offset, file_size)的校验和
+} SnapshotHeader;
 
-    // 遍历所有桶和链表节点
-    for (size_t i = 0; i < map->bucket_count; i++) {
-        HashNode* curr = map->buckets[i];
-        while (curr) {
-            arraylist_push_back(values, curr->value);
-            curr = curr->next;
+// 带缓冲的写入，按块更新校验和
+typedef struct {
+    FILE* file;
+    char* buffer;
+    size_t used;
+    uint64_t checksum;
+    bool ok;
+} SnapshotWriter;
+
+static void writer_flush(SnapshotWriter* writer) {
+    if (writer->used == 0) return;
+    writer->checksum = hash_bytes(writer->buffer, writer->used, writer->checksum);
+    writer->ok &= fwrite(writer->buffer, 1, writer->used, writer->file) == writer->used;
+    writer->used = 0;
+}
+
+// data为NULL时写入size个0
+static void writer_write(SnapshotWriter* writer, const void* data, size_t size) {
+    const char* src = data;
+    while (size > 0) {
+        size_t n = SNAPSHOT_CHUNK - writer->used < size ? SNAPSHOT_CHUNK - writer->used : size;
+        if (src) {
+            memcpy(writer->buffer + writer->used, src, n);
+            src += n;
+        }
+        else {
+            memset(writer->buffer + writer->used, 0, n);
+        }
+        writer->used += n;
+        size -= n;
+        if (writer->used == SNAPSHOT_CHUNK) {
+            writer_flush(writer);
         }
     }
+}
 
-    return values;
+// 校验和的初值：checksum之前的全部头部字段，篡改size或capacity也能被发现
+static uint64_t snapshot_checksum_seed(const SnapshotHeader* header) {
+    return hash_bytes(header, offsetof(SnapshotHeader, checksum), HASH_DEFAULT_SEED);
+}
+
+static uint64_t snapshot_checksum(const SnapshotHeader* header, const char* data, size_t size) {
+    uint64_t checksum = snapshot_checksum_seed(header);
+    for (size_t offset = 0; offset < size; offset += SNAPSHOT_CHUNK) {
+        size_t n = size - offset < SNAPSHOT_CHUNK ? size - offset : SNAPSHOT_CHUNK;
+        checksum = hash_bytes(data + offset, n, checksum);
+    }
+    return checksum;
+}
+
+bool hashmap_save_snapshot(HashMap map, const char* path) {
+    finish_migration(map);
+    const Table* table = &map->table;
+
+    SnapshotHeader header = {
+        .magic = SNAPSHOT_MAGIC,
+        .version = SNAPSHOT_VERSION,
+        .header_size = sizeof(SnapshotHeader),
+        .word_size = sizeof(size_t),
+        .key_size = map->key_size,
+        .value_size = map->value_size,
+        .key_offset = map->key_offset,
+        .value_offset = map->value_offset,
+        .slot_size = map->slot_size,
+        .capacity = table->capacity,
+        .size = table->size
+    };
+    header.ctrl_offset = round_up(sizeof(SnapshotHeader), SNAPSHOT_ALIGNMENT);
+    header.slots_offset = round_up(header.ctrl_offset + table->capacity + GROUP_WIDTH, SNAPSHOT_ALIGNMENT);
+    header.file_size = header.slots_offset + table->capacity * map->slot_size;
+
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        LOG_ERROR("Failed to open HashMap snapshot file: %s", path);
+        return false;
+    }
+
+    SnapshotWriter writer = {
+        .file = file,
+        .buffer = allocator_allocate(map->allocator, SNAPSHOT_CHUNK + map->slot_size),
+        .checksum = snapshot_checksum_seed(&header),
+        .ok = true
+    };
+    // 槽位逐个写出：只复制哈希、键和值，空槽位和填充字节写0，相同内容的表得到相同的文件
+    char* slot = writer.buffer + SNAPSHOT_CHUNK;
+
+    writer.ok &= fwrite(&header, sizeof(SnapshotHeader), 1, file) == 1;
+    writer.ok &= fseek(file, (long)header.ctrl_offset, SEEK_SET) == 0;
+    writer_write(&writer, table->ctrl, table->capacity + GROUP_WIDTH);
+    writer_write(&writer, NULL, header.slots_offset - (header.ctrl_offset + table->capacity + GROUP_WIDTH));
+    for (size_t i = 0; i < table->capacity; i++) {
+        memset(slot, 0, map->slot_size);
+        if (table->ctrl[i] >= 0) {
+            *(size_t*)slot = slot_hash(map, table, i);
+            memcpy(slot + map->key_offset, slot_key(map, table, i), map->key_size);
+            memcpy(slot + map->value_offset, slot_value(map, table, i), map->value_size);
+        }
+        writer_write(&writer, slot, map->slot_size);
+    }
+    writer_flush(&writer);
+
+    // 校验和在写完内容后才确定，最后回写头部
+    header.checksum = writer.checksum;
+    writer.ok &= fseek(file, 0, SEEK_SET) == 0;
+    writer.ok &= fwrite(&header, sizeof(SnapshotHeader), 1, file) == 1;
+    writer.ok &= fclose(file) == 0;
+    allocator_deallocate(map->allocator, writer.buffer, SNAPSHOT_CHUNK + map->slot_size);
+
+    if (!writer.ok) {
+        LOG_ERROR("Failed to write HashMap snapshot: %s", path);
+        remove(path);
+    }
+    return writer.ok;
+}
+
+// 检查头部与文件大小、当前平台和期望的槽位布局是否一致，返回错误原因，一致时返回NULL
+static const char* validate_snapshot(const SnapshotHeader* header, size_t file_size, const HashMap layout) {
+    if (file_size < sizeof(SnapshotHeader) || header->magic != SNAPSHOT_MAGIC) return "bad magic";
+    if (header->version != SNAPSHOT_VERSION) return "unsupported version";
+    if (header->header_size != sizeof(SnapshotHeader) || header->word_size != sizeof(size_t)) return "incompatible platform";
+    if (header->file_size != file_size) return "truncated file";
+    if (header->key_size != layout->key_size || header->value_size != layout->value_size) return "key or value size mismatch";
+    if (header->key_offset != layout->key_offset || header->value_offset != layout->value_offset ||
+        header->slot_size != layout->slot_size) return "slot layout mismatch";
+
+    uint64_t capacity = header->capacity;
+    if (capacity < MIN_CAPACITY || (capacity & (capacity - 1)) || header->size > capacity) return "bad capacity";
+
+    // 各段都必须落在文件内；先限制偏移再做加法和乘法，避免回绕
+    uint64_t ctrl_offset = header->ctrl_offset;
+    uint64_t slots_offset = header->slots_offset;
+    if (ctrl_offset % SNAPSHOT_ALIGNMENT || slots_offset % SNAPSHOT_ALIGNMENT ||
+        ctrl_offset < sizeof(SnapshotHeader) || ctrl_offset > file_size || slots_offset > file_size) return "bad section offsets";
+    if (capacity > file_size - ctrl_offset || ctrl_offset + capacity + GROUP_WIDTH > slots_offset) return "bad ctrl section";
+    if (capacity > UINT64_MAX / layout->slot_size || capacity * layout->slot_size > file_size - slots_offset) return "bad slot section";
+    return NULL;
+}
+
+// 不校验内容时也要保证查找能终止：至少有一个空槽位，末尾镜像与开头一致
+static const char* validate_ctrl(const int8_t* ctrl, size_t capacity) {
+    if (!memchr(ctrl, (unsigned char)CTRL_EMPTY, capacity)) return "no empty slot";
+    if (memcmp(ctrl, ctrl + capacity, GROUP_WIDTH) != 0) return "ctrl mirror mismatch";
+    return NULL;
+}
+
+HashMap hashmap_open_snapshot(const char* path, size_t key_size, size_t value_size,
+    HashFunc hash_func, KeyEqual key_equal, bool verify_checksum, Allocator* allocator) {
+    if (!allocator) allocator = get_default_allocator();
+
+    size_t file_size = 0;
+    const char* data = vm_map_file(path, &file_size);
+    if (!data) {
+        LOG_ERROR("Failed to map HashMap snapshot: %s", path);
+        return NULL;
+    }
+
+    HashMap map = allocator_allocate(allocator, sizeof(struct HashMap));
+    memset(map, 0, sizeof(struct HashMap));
+    init_layout(map, key_size, value_size);
+
+    const SnapshotHeader* header = (const SnapshotHeader*)data;
+    const char* error = validate_snapshot(header, file_size, map);
+    if (!error) {
+        error = validate_ctrl((const int8_t*)(data + header->ctrl_offset), (size_t)header->capacity);
+    }
+    if (!error && verify_checksum &&
+        snapshot_checksum(header, data + header->ctrl_offset, file_size - header->ctrl_offset) != header->checksum) {
+        error = "checksum mismatch";
+    }
+    if (error) {
+        LOG_ERROR("Invalid HashMap snapshot %s: %s", path, error);
+        vm_unmap_file(data, file_size);
+        allocator_deallocate(allocator, map, sizeof(struct HashMap));
+        return NULL;
+    }
+
+    // 表直接指向映射的内存，查询不做任何复制
+    map->table.ctrl = (int8_t*)(data + header->ctrl_offset);
+    map->table.slots = (char*)(data + header->slots_offset);
+    map->table.capacity = header->capacity;
+    map->table.size = header->size;
+    map->table.growth_left = 0;
+    map->hash_func = hash_func;
+    map->mix_hash = needs_mixing(hash_func);
+    map->key_equal = key_equal;
+    map->allocator = allocator;
+    map->mapping = data;
+    map->mapping_size = file_size;
+    return map;
+}
+
+bool hashmap_is_snapshot(const HashMap map) {
+    return map->mapping != NULL;
 }
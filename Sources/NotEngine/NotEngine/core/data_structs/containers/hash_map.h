@@ -3,6 +3,7 @@
 #include "typedefs.h"
 #include "alloctor/allocator.h"
 #include "iterator/iterator.h"
+#include "hash/hash.h"
 
 typedef struct HashMap* HashMap;
 typedef size_t(*HashFunc)(const void* key);
@@ -14,11 +15,25 @@ typedef struct {
     void* value;
 } HashMapPair;
 
-// 创建HashMap
+// 遍历回调，key和value指向表内的存储
+typedef void (*HashMapVisitor)(void* key, void* value, void* user_data);
+
+// 创建HashMap，hash_func和key_equal都为NULL时按字节哈希和比较整个键
+// 每个元素缓存完整的哈希值，扩容迁移时不再调用hash_func
+// 自定义hash_func的结果会再经过一次乘法混合，恒等哈希也能均匀分布；hash/hash.h中的内置函数不再混合
 API HashMap hashmap_create(size_t key_size, size_t value_size,
     HashFunc hash_func, KeyEqual key_equal,
     Allocator* allocator);
 
+// 创建以uint32_t为键的HashMap，使用内置整数哈希
+API HashMap hashmap_create_u32(size_t value_size, Allocator* allocator);
+
+// 创建以uint64_t为键的HashMap，使用内置整数哈希
+API HashMap hashmap_create_u64(size_t value_size, Allocator* allocator);
+
+// 创建按字节哈希和比较键的HashMap，适合不含填充字节的POD键
+API HashMap hashmap_create_bytes(size_t key_size, size_t value_size, Allocator* allocator);
+
 // 销毁HashMap
 API void hashmap_destroy(HashMap map);
 
@@ -43,16 +58,85 @@ API size_t hashmap_bucket_count(const HashMap map);
 // 获取负载因子
 API float hashmap_load_factor(const HashMap map);
 
-// 重新设置桶数量
+// 重新设置桶数量，总是一次完成
 API void hashmap_rehash(HashMap map, size_t bucket_count);
 
+// 增量重建：扩容时保留旧表，之后每次插入、查找、删除最多迁移step个旧槽位，
+// 把一次性重建的停顿分摊到后续操作；0表示关闭（默认），关闭时立即完成未迁移的部分
+API void hashmap_set_incremental_rehash(HashMap map, size_t step);
+
+// 预留空间，之后插入到共count个元素前不会再扩容
+API void hashmap_reserve(HashMap map, size_t count);
+
+// 批量插入count个键值对，keys和values分别是连续存放的键数组和值数组，返回新插入的数量
+// 先按最终大小一次扩容，再成批计算哈希并预取探测位置
+API size_t hashmap_insert_batch(HashMap map, const void* keys, const void* values, size_t count);
+
+// 批量查找count个键，values_out按键的顺序写入值（未找到的位置保持不变），found_out记录每个键是否存在
+// values_out和found_out可为NULL，返回找到的数量
+API size_t hashmap_get_batch(const HashMap map, const void* keys, size_t count, void* values_out, bool* found_out);
+
 // 检查是否为空
 API bool hashmap_empty(const HashMap map);
 
 // 检查键是否存在
 API bool hashmap_contains(const HashMap map, const void* key);
-API void hashmap_get_pair(Iterator it, void* key,void* value);  // 新增：获取键值对
 
+// 获取开始和结束迭代器，迭代器的get/set操作值；遍历期间不能插入或删除
+API Iterator hashmap_begin(HashMap map);
+API Iterator hashmap_end(HashMap map);
+
+// 复制迭代器所指的键值对，key或value为NULL时跳过
+API void hashmap_get_pair(Iterator it, void* key,void* value);
+
+// 获取迭代器所指的键值对地址，不复制
+API HashMapPair hashmap_iterator_pair(Iterator it);
+
+// 游标遍历：cursor从0开始，每次返回下一个键值对的地址，遍历完返回false
+API bool hashmap_next(const HashMap map, size_t* cursor, HashMapPair* pair);
+
+// 对每个键值对调用visitor，回调中可以修改值，但不能插入或删除
+API void hashmap_for_each(const HashMap map, HashMapVisitor visitor, void* user_data);
+
+// 游标的取值范围[0, hashmap_slot_count)，可按区间切分后交给不同线程
+API size_t hashmap_slot_count(const HashMap map);
+
+// 只遍历游标区间[begin, end)内的键值对
+API void hashmap_for_each_range(const HashMap map, size_t begin, size_t end,
+    HashMapVisitor visitor, void* user_data);
+
+// 多线程遍历，thread_count为0时使用CPU核数；visitor会被并发调用，遍历期间不能修改表
+API void hashmap_parallel_for_each(const HashMap map, HashMapVisitor visitor, void* user_data, size_t thread_count);
+
+// 用map的哈希函数计算键的哈希值（包括对自定义哈希的混合）
+API size_t hashmap_hash_key(const HashMap map, const void* key);
+
+// 以下函数使用预先算好的哈希值（须等于hashmap_hash_key的结果），供上层结构复用同一次哈希
+// 返回的值地址在下一次插入、删除或重建前有效
+
+// 查找值的地址，不存在返回NULL
+API void* hashmap_find_hashed(const HashMap map, const void* key, size_t hash);
+
+// 查找值的地址，不存在时插入键并返回未初始化的值地址，inserted返回是否为新插入
+API void* hashmap_emplace_hashed(HashMap map, const void* key, size_t hash, bool* inserted);
+
+// 删除键值对，返回删除的数量
+API size_t hashmap_erase_hashed(HashMap map, const void* key, size_t hash);
+
+// 快照：把表按内存布局原样写入文件，之后映射文件即可原地查询，不需要解析和复制
+// 键和值须是不含指针的定长数据，哈希函数须在不同进程间结果一致（内置哈希满足）
+
+// 保存快照，会先完成未迁移的增量重建；失败时返回false并删除不完整的文件
+API bool hashmap_save_snapshot(HashMap map, const char* path);
+
+// 以只读方式映射快照，key_size、value_size和哈希函数须与保存时一致
+// verify_checksum为true时先校验整个文件（需要读一遍文件），否则只检查头部
+// 返回的HashMap可以查找和遍历，不能插入、删除或重建（这些调用记录错误后直接返回）；用hashmap_destroy关闭
+API HashMap hashmap_open_snapshot(const char* path, size_t key_size, size_t value_size,
+    HashFunc hash_func, KeyEqual key_equal, bool verify_checksum, Allocator* allocator);
+
+// 检查是否为映射的只读快照
+API bool hashmap_is_snapshot(const HashMap map);
 
 // 获取所有keys或values
 API ArrayList hashmap_keys(HashMap map);
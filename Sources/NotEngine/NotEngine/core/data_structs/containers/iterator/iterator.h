@@ -7,6 +7,7 @@ typedef struct Iterator {
     void* ptr;           // 当前位置指针
     void* container;     // 指向容器的指针
     size_t elem_size;    // 元素大小
+    void* node;          // 容器自用的附加位置，如deque当前块在块数组中的地址
 
     // 迭代器操作函数指针
     struct Iterator(*next)(struct Iterator);  // ++it
@@ -1,31 +1,39 @@
 ﻿#include <stdio.h>
 #include <string.h>
 #include "linked_list.h"
+#include "alloctor/pool_allocator.h"
 
 #include <crtdbg.h>
 #include <stdlib.h>
 
-// 链表节点结构
+// 链表节点结构，数据紧跟在节点之后
 typedef struct Node {
     struct Node* prev;    // 前一个节点
     struct Node* next;    // 后一个节点
-    void* data;          // 数据指针
 } Node;
 
+// 节点头大小，保证数据区按默认对齐
+#define NODE_HEADER_SIZE \
+    ((sizeof(Node) + ALLOCATOR_DEFAULT_ALIGNMENT - 1) & ~(ALLOCATOR_DEFAULT_ALIGNMENT - 1))
+
 struct LinkedList {
     Node* head;          // 头节点
     Node* tail;          // 尾节点
     size_t element_size; // 元素大小
     size_t size;           // 当前元素个数
     Allocator* allocator;// 内存分配器
+    PoolAllocator node_pool; // 节点池，节点与数据一次分配
 };
 
+static void* node_data(Node* node) {
+    return (char*)node + NODE_HEADER_SIZE;
+}
+
 // 创建新节点
 static Node* create_node(LinkedList list, const void* element) {
-    Node* node = list->allocator->allocate(sizeof(Node));
-    node->data = list->allocator->allocate(list->element_size);
+    Node* node = pool_alloc(list->node_pool);
     if (element) {
-        memcpy(node->data, element, list->element_size);
+        memcpy(node_data(node), element, list->element_size);
     }
     node->prev = NULL;
     node->next = NULL;
@@ -34,8 +42,7 @@ static Node* create_node(LinkedList list, const void* element) {
 
 // 销毁节点
 static void destroy_node(LinkedList list, Node* node) {
-    list->allocator->deallocate(node->data);
-    list->allocator->deallocate(node);
+    pool_free(list->node_pool, node);
 }
 
 LinkedList linkedlist_create(size_t element_size, Allocator* allocator) {
@@ -43,19 +50,20 @@ LinkedList linkedlist_create(size_t element_size, Allocator* allocator) {
         allocator = get_default_allocator();
     }
 
-    LinkedList list = allocator->allocate(sizeof(LinkedList));
+    LinkedList list = allocator_allocate(allocator, sizeof(struct LinkedList));
 
     list->head = NULL;
     list->tail = NULL;
     list->element_size = element_size;
     list->size = 0;
     list->allocator = allocator;
+    list->node_pool = pool_create(NODE_HEADER_SIZE + element_size, 0, allocator);
     return list;
 }
 
 void linkedlist_destroy(LinkedList list) {
-    linkedlist_clear(list);
-    list->allocator->deallocate(list);
+    pool_destroy(list->node_pool);
+    allocator_deallocate(list->allocator, list, sizeof(struct LinkedList));
 }
 
 void linkedlist_push_front(LinkedList list, const void* element) {
@@ -90,7 +98,7 @@ void linkedlist_pop_front(LinkedList list,void* dest) {
     if (list->head == NULL) return;
     if (dest)
     {
-        memcpy(dest, list->head->data, list->element_size);
+        memcpy(dest, node_data(list->head), list->element_size);
     }
 
     Node* old_head = list->head;
@@ -111,7 +119,7 @@ void linkedlist_pop_back(LinkedList list,void* dest) {
     if (list->tail == NULL) return;
     if (dest)
     {
-        memcpy(dest, list->tail->data, list->element_size);
+        memcpy(dest, node_data(list->tail), list->element_size);
     }
     Node* old_tail = list->tail;
     list->tail = old_tail->prev;
@@ -129,11 +137,11 @@ void linkedlist_pop_back(LinkedList list,void* dest) {
 
 
 void linkedlist_front(const LinkedList list, void* out) {
-    memcpy(out, list->head->data, list->element_size);
+    memcpy(out, node_data(list->head), list->element_size);
 }
 
 void linkedlist_back(const LinkedList list, void* out) {
-    memcpy(out, list->tail->data, list->element_size);
+    memcpy(out, node_data(list->tail), list->element_size);
 }
 
 size_t linkedlist_size(const LinkedList list) {
@@ -145,9 +153,11 @@ bool linkedlist_empty(const LinkedList list) {
 }
 
 void linkedlist_clear(LinkedList list) {
-    while (!linkedlist_empty(list)) {
-        linkedlist_pop_front(list,NULL);
-    }
+    // 节点全部来自节点池，整体归还即可
+    pool_clear(list->node_pool);
+    list->head = NULL;
+    list->tail = NULL;
+    list->size = 0;
 }
 
 // LinkedList的迭代器操作
@@ -169,15 +179,15 @@ static Iterator list_iterator_prev(Iterator it) {
 
 static void list_iterator_get(Iterator it, void* dest) {
     Node* node = it.ptr;
-    if (node && node->data) {
-        memcpy(dest, node->data, it.elem_size);
+    if (node) {
+        memcpy(dest, node_data(node), it.elem_size);
     }
 }
 
 static void list_iterator_set(Iterator it, const void* value) {
     Node* node = it.ptr;
-    if (node && node->data) {
-        memcpy(node->data, value, it.elem_size);
+    if (node) {
+        memcpy(node_data(node), value, it.elem_size);
     }
 }
 
@@ -345,9 +355,37 @@ void linkedlist_remove_if(LinkedList list, bool (*pred)(const void*)) {
     free(temp);
 }
 
+// 节点的所有权转移给list：两个池能合并时直接接管other的slab，
+// 否则（backing或元素大小不同）逐个复制到list的池中并归还other的节点
+static void adopt_nodes(LinkedList list, LinkedList other) {
+    if (pool_merge(list->node_pool, other->node_pool)) return;
+
+    Node* head = NULL;
+    Node* tail = NULL;
+    Node* node = other->head;
+    for (size_t i = 0; i < other->size; i++) {
+        Node* next = node->next;
+        Node* copy = create_node(list, node_data(node));
+        copy->prev = tail;
+        if (tail) {
+            tail->next = copy;
+        }
+        else {
+            head = copy;
+        }
+        tail = copy;
+        destroy_node(other, node);
+        node = next;
+    }
+    other->head = head;
+    other->tail = tail;
+}
+
 void linkedlist_splice(LinkedList list, Iterator pos, LinkedList other) {
     if (other->size == 0) return;
 
+    adopt_nodes(list, other);
+
     Node* pos_node = pos.ptr;
 
     // 调整other的前后节点连接
@@ -1,8 +1,8 @@
 ﻿#pragma once
 #include <stddef.h>
 
-#include "core/data_structs/alloctor/allocator.h"
-#include "core/data_structs/iterator/iterator.h"
+#include "alloctor/allocator.h"
+#include "iterator/iterator.h"
 
 typedef struct LinkedList* LinkedList;
 
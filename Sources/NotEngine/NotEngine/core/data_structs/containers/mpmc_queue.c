@@ -0,0 +1,207 @@
+﻿#include <string.h>
+#include "mpmc_queue.h"
+
+#define CACHE_LINE_SIZE 64
+
+// 槽位：序号在前，元素紧随其后并按max_align_t对齐
+// 序号等于pos表示第pos次入队可以写入，等于pos + 1表示第pos次出队可以读取，
+// 读取后设为pos + capacity，留给下一圈的入队
+typedef struct Slot {
+    _Alignas(max_align_t) atomic_size_t sequence;
+} Slot;
+
+struct MpmcQueue {
+    // 生产者竞争
+    _Alignas(CACHE_LINE_SIZE) atomic_size_t enqueue_pos;
+    // 消费者竞争
+    _Alignas(CACHE_LINE_SIZE) atomic_size_t dequeue_pos;
+    // 阻塞策略下消费者等待not_empty，生产者等待not_full
+    _Alignas(CACHE_LINE_SIZE) WaitEvent not_empty;
+    _Alignas(CACHE_LINE_SIZE) WaitEvent not_full;
+    // 只读
+    _Alignas(CACHE_LINE_SIZE) char* slots;
+    size_t mask;
+    size_t element_size;
+    size_t slot_size;
+    WaitStrategy wait;
+    Allocator* allocator;
+};
+
+static inline Slot* slot_at(MpmcQueue queue, size_t pos) {
+    return (Slot*)(queue->slots + (pos & queue->mask) * queue->slot_size);
+}
+
+static inline void* slot_data(Slot* slot) {
+    return slot + 1;
+}
+
+MpmcQueue mpmc_queue_create(size_t element_size, size_t capacity, WaitStrategy wait, Allocator* allocator) {
+    if (!allocator) allocator = get_default_allocator();
+
+    // 容量为1时入队后序号pos + 1与下一次入队的pos相同，无法区分满和空
+    size_t rounded = 2;
+    while (rounded < capacity) {
+        rounded *= 2;
+    }
+
+    MpmcQueue queue = allocator_allocate_aligned(allocator, sizeof(struct MpmcQueue), CACHE_LINE_SIZE);
+    memset(queue, 0, sizeof(struct MpmcQueue));
+    atomic_init(&queue->enqueue_pos, 0);
+    atomic_init(&queue->dequeue_pos, 0);
+    wait_event_init(&queue->not_empty);
+    wait_event_init(&queue->not_full);
+    queue->mask = rounded - 1;
+    queue->element_size = element_size;
+    queue->slot_size = (sizeof(Slot) + element_size + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1);
+    queue->wait = wait;
+    queue->allocator = allocator;
+
+    queue->slots = allocator_allocate_aligned(allocator, rounded * queue->slot_size, CACHE_LINE_SIZE);
+    for (size_t i = 0; i < rounded; i++) {
+        atomic_init(&slot_at(queue, i)->sequence, i);
+    }
+    return queue;
+}
+
+void mpmc_queue_destroy(MpmcQueue queue) {
+    allocator_deallocate_aligned(queue->allocator, queue->slots, (queue->mask + 1) * queue->slot_size, CACHE_LINE_SIZE);
+    allocator_deallocate_aligned(queue->allocator, queue, sizeof(struct MpmcQueue), CACHE_LINE_SIZE);
+}
+
+// 发布槽位后唤醒可能在休眠的另一端，多个元素可能满足多个等待者
+static void notify(MpmcQueue queue, WaitEvent* event, size_t count) {
+    if (queue->wait == WAIT_STRATEGY_BLOCK) {
+        wait_event_notify(event, count > 1);
+    }
+}
+
+// 从pos开始数连续多少个槽位的序号等于pos + offset，最多count个
+static size_t count_ready(MpmcQueue queue, size_t pos, size_t offset, size_t count) {
+    size_t ready = 0;
+    while (ready < count) {
+        size_t sequence = atomic_load_explicit(&slot_at(queue, pos + ready)->sequence, memory_order_acquire);
+        if (sequence != pos + ready + offset) break;
+        ready++;
+    }
+    return ready;
+}
+
+// 抢占从下标开始的连续槽位，offset为0时找空槽位，为1时找已填充的槽位
+// 第一个槽位落后于下标说明队列满或空；领先说明其他线程已经抢走，重新读取下标
+static size_t claim(MpmcQueue queue, atomic_size_t* position, size_t offset, size_t count, size_t* claimed_pos) {
+    size_t pos = atomic_load_explicit(position, memory_order_relaxed);
+    for (;;) {
+        size_t sequence = atomic_load_explicit(&slot_at(queue, pos)->sequence, memory_order_acquire);
+        ptrdiff_t diff = (ptrdiff_t)(sequence - (pos + offset));
+        if (diff < 0) return 0;
+        if (diff > 0) {
+            pos = atomic_load_explicit(position, memory_order_relaxed);
+            continue;
+        }
+
+        size_t ready = count == 1 ? 1 : count_ready(queue, pos, offset, count);
+        if (ready == 0) {
+            pos = atomic_load_explicit(position, memory_order_relaxed);
+            continue;
+        }
+        if (atomic_compare_exchange_weak_explicit(position, &pos, pos + ready, memory_order_relaxed, memory_order_relaxed)) {
+            *claimed_pos = pos;
+            return ready;
+        }
+    }
+}
+
+size_t mpmc_queue_try_push_n(MpmcQueue queue, const void* elements, size_t count) {
+    if (count == 0) return 0;
+
+    size_t pos;
+    size_t claimed = claim(queue, &queue->enqueue_pos, 0, count, &pos);
+    const char* src = elements;
+    for (size_t i = 0; i < claimed; i++) {
+        Slot* slot = slot_at(queue, pos + i);
+        memcpy(slot_data(slot), src + i * queue->element_size, queue->element_size);
+        atomic_store_explicit(&slot->sequence, pos + i + 1, memory_order_release);
+    }
+    if (claimed) notify(queue, &queue->not_empty, claimed);
+    return claimed;
+}
+
+size_t mpmc_queue_try_pop_n(MpmcQueue queue, void* out, size_t count) {
+    if (count == 0) return 0;
+
+    size_t pos;
+    size_t claimed = claim(queue, &queue->dequeue_pos, 1, count, &pos);
+    char* dest = out;
+    for (size_t i = 0; i < claimed; i++) {
+        Slot* slot = slot_at(queue, pos + i);
+        memcpy(dest + i * queue->element_size, slot_data(slot), queue->element_size);
+        atomic_store_explicit(&slot->sequence, pos + i + queue->mask + 1, memory_order_release);
+    }
+    if (claimed) notify(queue, &queue->not_full, claimed);
+    return claimed;
+}
+
+bool mpmc_queue_try_push(MpmcQueue queue, const void* element) {
+    return mpmc_queue_try_push_n(queue, element, 1) == 1;
+}
+
+bool mpmc_queue_try_pop(MpmcQueue queue, void* out) {
+    return mpmc_queue_try_pop_n(queue, out, 1) == 1;
+}
+
+// 入队下标处的槽位已被上一圈的消费者释放
+static bool has_space(void* context) {
+    MpmcQueue queue = context;
+    size_t pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+    size_t sequence = atomic_load_explicit(&slot_at(queue, pos)->sequence, memory_order_acquire);
+    return (ptrdiff_t)(sequence - pos) >= 0;
+}
+
+// 出队下标处的槽位已被生产者填充
+static bool has_element(void* context) {
+    MpmcQueue queue = context;
+    size_t pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+    size_t sequence = atomic_load_explicit(&slot_at(queue, pos)->sequence, memory_order_acquire);
+    return (ptrdiff_t)(sequence - (pos + 1)) >= 0;
+}
+
+void mpmc_queue_push_n(MpmcQueue queue, const void* elements, size_t count) {
+    const char* src = elements;
+    while (count > 0) {
+        size_t pushed = mpmc_queue_try_push_n(queue, src, count);
+        if (pushed == 0) {
+            wait_event_wait(&queue->not_full, queue->wait, has_space, queue);
+            continue;
+        }
+        src += pushed * queue->element_size;
+        count -= pushed;
+    }
+}
+
+size_t mpmc_queue_pop_n(MpmcQueue queue, void* out, size_t count) {
+    if (count == 0) return 0;
+    for (;;) {
+        size_t popped = mpmc_queue_try_pop_n(queue, out, count);
+        if (popped) return popped;
+        wait_event_wait(&queue->not_empty, queue->wait, has_element, queue);
+    }
+}
+
+void mpmc_queue_push(MpmcQueue queue, const void* element) {
+    mpmc_queue_push_n(queue, element, 1);
+}
+
+void mpmc_queue_pop(MpmcQueue queue, void* out) {
+    mpmc_queue_pop_n(queue, out, 1);
+}
+
+size_t mpmc_queue_size(const MpmcQueue queue) {
+    size_t head = atomic_load_explicit(&queue->dequeue_pos, memory_order_acquire);
+    size_t tail = atomic_load_explicit(&queue->enqueue_pos, memory_order_acquire);
+    size_t size = tail >= head ? tail - head : 0;
+    return size > queue->mask + 1 ? queue->mask + 1 : size;
+}
+
+size_t mpmc_queue_capacity(const MpmcQueue queue) {
+    return queue->mask + 1;
+}
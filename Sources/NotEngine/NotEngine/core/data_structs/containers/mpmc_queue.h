@@ -0,0 +1,43 @@
+﻿#pragma once
+#include "alloctor/allocator.h"
+#include "atomic_wait.h"
+
+// 多生产者多消费者的无锁有界队列
+// 每个槽位带一个序号，生产者和消费者各自用CAS抢占下标，抢到后独占该槽位读写，出入队不加锁也不分配内存
+typedef struct MpmcQueue* MpmcQueue;
+
+// 创建队列，capacity向上取整为2的幂（至少为2），wait决定阻塞版本的出入队如何等待
+API MpmcQueue mpmc_queue_create(size_t element_size, size_t capacity, WaitStrategy wait, Allocator* allocator);
+
+// 销毁队列，调用时不能有线程还在使用
+API void mpmc_queue_destroy(MpmcQueue queue);
+
+// 尝试入队，队列满时返回false
+API bool mpmc_queue_try_push(MpmcQueue queue, const void* element);
+
+// 尝试出队，队列空时返回false
+API bool mpmc_queue_try_pop(MpmcQueue queue, void* out);
+
+// 尽量入队count个连续存放的元素，一次CAS占用连续的空槽位，返回实际入队的数量
+API size_t mpmc_queue_try_push_n(MpmcQueue queue, const void* elements, size_t count);
+
+// 最多出队count个元素到out，一次CAS占用连续的已填充槽位，返回实际出队的数量
+API size_t mpmc_queue_try_pop_n(MpmcQueue queue, void* out, size_t count);
+
+// 入队，队列满时按等待策略等待
+API void mpmc_queue_push(MpmcQueue queue, const void* element);
+
+// 出队，队列空时按等待策略等待
+API void mpmc_queue_pop(MpmcQueue queue, void* out);
+
+// 入队全部count个元素，空间不足时分批等待
+API void mpmc_queue_push_n(MpmcQueue queue, const void* elements, size_t count);
+
+// 等到至少有一个元素后最多出队count个，返回出队的数量
+API size_t mpmc_queue_pop_n(MpmcQueue queue, void* out, size_t count);
+
+// 当前元素个数，有其他线程同时操作时只是近似值
+API size_t mpmc_queue_size(const MpmcQueue queue);
+
+// 容量
+API size_t mpmc_queue_capacity(const MpmcQueue queue);
@@ -0,0 +1,252 @@
+﻿#include <string.h>
+#include "priority_queue.h"
+#include "core/logger/assert.h"
+
+#define INITIAL_CAPACITY 16
+// 空闲句柄在positions中以此位标记，其余位是下一个空闲句柄
+#define FREE_BIT 0x80000000u
+#define NO_FREE_HANDLE 0x7FFFFFFFu
+
+// data[i]是堆中第i个元素，handles[i]是它的句柄，positions[handle]是句柄对应元素在堆中的位置
+// 句柄总数不超过容量，三个数组一起扩容
+struct PriorityQueue {
+    char* data;
+    PriorityQueueHandle* handles;
+    uint32_t* positions;
+    char* scratch;          // 上浮/下沉时暂存移动中的元素
+    size_t size;
+    size_t capacity;
+    size_t handle_count;    // 分配过的句柄数
+    uint32_t free_handle;   // 空闲句柄链表头，NO_FREE_HANDLE表示为空
+    size_t element_size;
+    size_t arity;
+    Compare comp;
+    Allocator* allocator;
+};
+
+static inline char* element_at(const PriorityQueue pq, size_t pos) {
+    return pq->data + pos * pq->element_size;
+}
+
+// 把元素和句柄放到pos，并更新句柄的位置
+static inline void place(PriorityQueue pq, size_t pos, const void* element, PriorityQueueHandle handle) {
+    memcpy(element_at(pq, pos), element, pq->element_size);
+    pq->handles[pos] = handle;
+    pq->positions[handle] = (uint32_t)pos;
+}
+
+// 把from处的元素移到to
+static inline void move(PriorityQueue pq, size_t from, size_t to) {
+    place(pq, to, element_at(pq, from), pq->handles[from]);
+}
+
+PriorityQueue priority_queue_create(size_t element_size, size_t arity, Compare comp, Allocator* allocator) {
+    if (!allocator) allocator = get_default_allocator();
+
+    PriorityQueue pq = allocator_allocate(allocator, sizeof(struct PriorityQueue));
+    memset(pq, 0, sizeof(struct PriorityQueue));
+    pq->element_size = element_size;
+    pq->arity = arity == 4 ? 4 : 2;
+    pq->comp = comp;
+    pq->free_handle = NO_FREE_HANDLE;
+    pq->allocator = allocator;
+    pq->scratch = allocator_allocate(allocator, element_size);
+    return pq;
+}
+
+void priority_queue_destroy(PriorityQueue pq) {
+    allocator_deallocate(pq->allocator, pq->data, pq->capacity * pq->element_size);
+    allocator_deallocate(pq->allocator, pq->handles, pq->capacity * sizeof(PriorityQueueHandle));
+    allocator_deallocate(pq->allocator, pq->positions, pq->capacity * sizeof(uint32_t));
+    allocator_deallocate(pq->allocator, pq->scratch, pq->element_size);
+    allocator_deallocate(pq->allocator, pq, sizeof(struct PriorityQueue));
+}
+
+void priority_queue_reserve(PriorityQueue pq, size_t capacity) {
+    if (capacity <= pq->capacity) return;
+    ASSERT_MSG(capacity <= NO_FREE_HANDLE, "PriorityQueue capacity exceeds handle range");
+
+    pq->data = allocator_reallocate(pq->allocator, pq->data,
+        pq->capacity * pq->element_size, capacity * pq->element_size);
+    pq->handles = allocator_reallocate(pq->allocator, pq->handles,
+        pq->capacity * sizeof(PriorityQueueHandle), capacity * sizeof(PriorityQueueHandle));
+    pq->positions = allocator_reallocate(pq->allocator, pq->positions,
+        pq->capacity * sizeof(uint32_t), capacity * sizeof(uint32_t));
+    pq->capacity = capacity;
+}
+
+static void grow(PriorityQueue pq, size_t needed) {
+    size_t capacity = pq->capacity ? pq->capacity : INITIAL_CAPACITY;
+    while (capacity < needed) {
+        capacity *= 2;
+    }
+    priority_queue_reserve(pq, capacity);
+}
+
+static PriorityQueueHandle acquire_handle(PriorityQueue pq) {
+    if (pq->free_handle != NO_FREE_HANDLE) {
+        PriorityQueueHandle handle = pq->free_handle;
+        pq->free_handle = pq->positions[handle] & ~FREE_BIT;
+        return handle;
+    }
+    return (PriorityQueueHandle)pq->handle_count++;
+}
+
+static void release_handle(PriorityQueue pq, PriorityQueueHandle handle) {
+    pq->positions[handle] = pq->free_handle | FREE_BIT;
+    pq->free_handle = handle;
+}
+
+// 空穴法：element沿路径移动，途经的元素逐个挪位，最后一次写入element
+// arity以常量传入，内联后子节点循环可以展开
+static inline size_t sift_up_impl(PriorityQueue pq, size_t pos, const void* element, size_t arity) {
+    while (pos > 0) {
+        size_t parent = (pos - 1) / arity;
+        if (pq->comp(element_at(pq, parent), element) >= 0) break;
+        move(pq, parent, pos);
+        pos = parent;
+    }
+    return pos;
+}
+
+static inline size_t sift_down_impl(PriorityQueue pq, size_t pos, const void* element, size_t arity) {
+    size_t size = pq->size;
+    for (;;) {
+        size_t first = pos * arity + 1;
+        if (first >= size) break;
+
+        size_t last = first + arity < size ? first + arity : size;
+        size_t best = first;
+        for (size_t child = first + 1; child < last; child++) {
+            if (pq->comp(element_at(pq, best), element_at(pq, child)) < 0) best = child;
+        }
+        if (pq->comp(element, element_at(pq, best)) >= 0) break;
+        move(pq, best, pos);
+        pos = best;
+    }
+    return pos;
+}
+
+// 把element（句柄为handle）从pos开始上浮后放下；element不能指向堆内存储
+static void sift_up(PriorityQueue pq, size_t pos, const void* element, PriorityQueueHandle handle) {
+    pos = pq->arity == 4 ? sift_up_impl(pq, pos, element, 4) : sift_up_impl(pq, pos, element, 2);
+    place(pq, pos, element, handle);
+}
+
+static void sift_down(PriorityQueue pq, size_t pos, const void* element, PriorityQueueHandle handle) {
+    pos = pq->arity == 4 ? sift_down_impl(pq, pos, element, 4) : sift_down_impl(pq, pos, element, 2);
+    place(pq, pos, element, handle);
+}
+
+// 把element放到pos：比父节点大则上浮，否则下沉
+static void reposition(PriorityQueue pq, size_t pos, const void* element, PriorityQueueHandle handle) {
+    if (pos > 0 && pq->comp(element_at(pq, (pos - 1) / pq->arity), element) < 0) {
+        sift_up(pq, pos, element, handle);
+    }
+    else {
+        sift_down(pq, pos, element, handle);
+    }
+}
+
+PriorityQueueHandle priority_queue_push(PriorityQueue pq, const void* element) {
+    if (pq->size == pq->capacity) grow(pq, pq->size + 1);
+
+    PriorityQueueHandle handle = acquire_handle(pq);
+    sift_up(pq, pq->size++, element, handle);
+    return handle;
+}
+
+void priority_queue_push_n(PriorityQueue pq, const void* elements, size_t count, PriorityQueueHandle* handles) {
+    if (count == 0) return;
+    if (pq->size + count > pq->capacity) grow(pq, pq->size + count);
+
+    // 逐个上浮约为O(count * log n)，重建堆为O(n)：新元素不少于现有元素时重建更快
+    const char* src = elements;
+    if (count < pq->size) {
+        for (size_t i = 0; i < count; i++) {
+            PriorityQueueHandle handle = priority_queue_push(pq, src + i * pq->element_size);
+            if (handles) handles[i] = handle;
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        PriorityQueueHandle handle = acquire_handle(pq);
+        place(pq, pq->size++, src + i * pq->element_size, handle);
+        if (handles) handles[i] = handle;
+    }
+    if (pq->size < 2) return;
+    for (size_t start = (pq->size - 2) / pq->arity + 1; start > 0; start--) {
+        size_t pos = start - 1;
+        memcpy(pq->scratch, element_at(pq, pos), pq->element_size);
+        sift_down(pq, pos, pq->scratch, pq->handles[pos]);
+    }
+}
+
+bool priority_queue_top(const PriorityQueue pq, void* out) {
+    if (pq->size == 0) return false;
+    memcpy(out, pq->data, pq->element_size);
+    return true;
+}
+
+PriorityQueueHandle priority_queue_top_handle(const PriorityQueue pq) {
+    return pq->size ? pq->handles[0] : PRIORITY_QUEUE_INVALID_HANDLE;
+}
+
+bool priority_queue_contains(const PriorityQueue pq, PriorityQueueHandle handle) {
+    return handle < pq->handle_count && !(pq->positions[handle] & FREE_BIT);
+}
+
+const void* priority_queue_get(const PriorityQueue pq, PriorityQueueHandle handle) {
+    ASSERT_MSG(priority_queue_contains(pq, handle), "Invalid PriorityQueue handle");
+    return element_at(pq, pq->positions[handle]);
+}
+
+// 删除pos处的元素：用末尾元素填补后重新定位
+static void remove_at(PriorityQueue pq, size_t pos, void* out) {
+    if (out) memcpy(out, element_at(pq, pos), pq->element_size);
+    release_handle(pq, pq->handles[pos]);
+
+    size_t last = --pq->size;
+    if (pos == last) return;
+
+    memcpy(pq->scratch, element_at(pq, last), pq->element_size);
+    reposition(pq, pos, pq->scratch, pq->handles[last]);
+}
+
+bool priority_queue_pop(PriorityQueue pq, void* out) {
+    if (pq->size == 0) return false;
+    remove_at(pq, 0, out);
+    return true;
+}
+
+void priority_queue_remove(PriorityQueue pq, PriorityQueueHandle handle, void* out) {
+    ASSERT_MSG(priority_queue_contains(pq, handle), "Invalid PriorityQueue handle");
+    remove_at(pq, pq->positions[handle], out);
+}
+
+void priority_queue_update(PriorityQueue pq, PriorityQueueHandle handle, const void* element) {
+    ASSERT_MSG(priority_queue_contains(pq, handle), "Invalid PriorityQueue handle");
+    memcpy(pq->scratch, element, pq->element_size);
+    reposition(pq, pq->positions[handle], pq->scratch, handle);
+}
+
+void priority_queue_decrease_key(PriorityQueue pq, PriorityQueueHandle handle, const void* element) {
+    ASSERT_MSG(priority_queue_contains(pq, handle), "Invalid PriorityQueue handle");
+    memcpy(pq->scratch, element, pq->element_size);
+    sift_up(pq, pq->positions[handle], pq->scratch, handle);
+}
+
+void priority_queue_clear(PriorityQueue pq) {
+    pq->size = 0;
+    pq->handle_count = 0;
+    pq->free_handle = NO_FREE_HANDLE;
+}
+
+size_t priority_queue_size(const PriorityQueue pq) {
+    return pq->size;
+}
+
+bool priority_queue_empty(const PriorityQueue pq) {
+    return pq->size == 0;
+}
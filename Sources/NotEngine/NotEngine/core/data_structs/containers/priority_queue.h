@@ -0,0 +1,63 @@
+﻿#pragma once
+#include <stdint.h>
+#include "alloctor/allocator.h"
+#include "algorithm/algorithm.h"
+
+// 优先队列：元素连续存放的隐式d叉堆（d为2或4），堆顶是comp意义下最大的元素，与make_heap一致
+// 需要最小堆（如寻路的开放列表）时传入反向的comp
+// 每个元素有一个句柄，元素在堆中移动时句柄不变，可用于修改优先级或删除；句柄在元素出堆后回收复用
+typedef struct PriorityQueue* PriorityQueue;
+
+typedef uint32_t PriorityQueueHandle;
+
+#define PRIORITY_QUEUE_INVALID_HANDLE UINT32_MAX
+
+// 创建优先队列，arity为堆的叉数（2或4，其他值按2处理）
+// 4叉堆层数减半，下沉时一次比较的子节点位于同一缓存行，适合出堆频繁的场景
+API PriorityQueue priority_queue_create(size_t element_size, size_t arity, Compare comp, Allocator* allocator);
+
+// 销毁优先队列
+API void priority_queue_destroy(PriorityQueue pq);
+
+// 入堆，返回元素的句柄
+API PriorityQueueHandle priority_queue_push(PriorityQueue pq, const void* element);
+
+// 批量入堆count个连续存放的元素，handles不为NULL时按顺序写入各元素的句柄
+// 新元素较多时整体重建堆（O(n)），否则逐个上浮
+API void priority_queue_push_n(PriorityQueue pq, const void* elements, size_t count, PriorityQueueHandle* handles);
+
+// 获取堆顶元素，队列为空时返回false
+API bool priority_queue_top(const PriorityQueue pq, void* out);
+
+// 堆顶元素的句柄，队列为空时返回PRIORITY_QUEUE_INVALID_HANDLE
+API PriorityQueueHandle priority_queue_top_handle(const PriorityQueue pq);
+
+// 弹出堆顶元素，out为NULL时直接丢弃；队列为空时返回false
+API bool priority_queue_pop(PriorityQueue pq, void* out);
+
+// 句柄是否指向仍在堆中的元素
+API bool priority_queue_contains(const PriorityQueue pq, PriorityQueueHandle handle);
+
+// 获取句柄对应元素的地址，不复制；下次修改队列后失效，不能通过它修改参与比较的字段
+API const void* priority_queue_get(const PriorityQueue pq, PriorityQueueHandle handle);
+
+// 把句柄对应的元素替换为新值，按新值上浮或下沉
+API void priority_queue_update(PriorityQueue pq, PriorityQueueHandle handle, const void* element);
+
+// 把句柄对应的元素替换为更靠近堆顶的新值（最小堆中即键值减小），只上浮
+API void priority_queue_decrease_key(PriorityQueue pq, PriorityQueueHandle handle, const void* element);
+
+// 删除句柄对应的元素，out不为NULL时复制出被删除的元素
+API void priority_queue_remove(PriorityQueue pq, PriorityQueueHandle handle, void* out);
+
+// 清空队列，所有句柄失效
+API void priority_queue_clear(PriorityQueue pq);
+
+// 预留至少capacity个元素的容量
+API void priority_queue_reserve(PriorityQueue pq, size_t capacity);
+
+// 元素个数
+API size_t priority_queue_size(const PriorityQueue pq);
+
+// 是否为空
+API bool priority_queue_empty(const PriorityQueue pq);
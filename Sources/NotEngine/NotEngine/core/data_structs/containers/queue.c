@@ -1,61 +1,248 @@
 ﻿#include <stdio.h>
+#include <string.h>
 #include "queue.h"
 
+#define QUEUE_INITIAL_CAPACITY 16
+
 struct Queue {
-    Deque deque;  // 使用deque作为底层容器
+    QueueStorage storage;
+    Deque deque;          // QUEUE_STORAGE_DEQUE的底层容器
+    char* data;           // 环形缓冲区
+    size_t capacity;      // 环形缓冲区容量，2的幂；至少保留一个空位，使结束位置不与开始位置重合
+    size_t head;          // 队头下标
+    size_t size;          // 环形缓冲区中的元素个数
+    size_t elem_size;
     Allocator* allocator;
 };
 
+static char* ring_at(const Queue queue, size_t index) {
+    return queue->data + ((queue->head + index) & (queue->capacity - 1)) * queue->elem_size;
+}
+
+// 容量翻倍直到能再放入count个元素，并把元素整理到新缓冲区开头
+static void ring_grow(Queue queue, size_t count) {
+    size_t needed = queue->size + count + 1;
+    size_t new_capacity = queue->capacity;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+
+    char* new_data = allocator_allocate(queue->allocator, new_capacity * queue->elem_size);
+    size_t first = queue->capacity - queue->head < queue->size ? queue->capacity - queue->head : queue->size;
+    memcpy(new_data, queue->data + queue->head * queue->elem_size, first * queue->elem_size);
+    memcpy(new_data + first * queue->elem_size, queue->data, (queue->size - first) * queue->elem_size);
+
+    allocator_deallocate(queue->allocator, queue->data, queue->capacity * queue->elem_size);
+    queue->data = new_data;
+    queue->capacity = new_capacity;
+    queue->head = 0;
+}
+
+// 保证能再放入count个元素；检查放在调用处，入队的常见路径不调用函数
+static inline void ring_reserve(Queue queue, size_t count) {
+    if (queue->size + count >= queue->capacity) {
+        ring_grow(queue, count);
+    }
+}
+
 Queue queue_create(size_t element_size, Allocator* allocator) {
+    return queue_create_with_storage(element_size, QUEUE_STORAGE_RING, allocator);
+}
+
+Queue queue_create_with_storage(size_t element_size, QueueStorage storage, Allocator* allocator) {
     if (!allocator) allocator = get_default_allocator();
 
-    Queue queue = allocator->allocate(sizeof(struct Queue));
-    queue->deque = deque_create(element_size, allocator);
+    Queue queue = allocator_allocate(allocator, sizeof(struct Queue));
+    memset(queue, 0, sizeof(struct Queue));
+    queue->storage = storage;
+    queue->elem_size = element_size;
     queue->allocator = allocator;
+    if (storage == QUEUE_STORAGE_DEQUE) {
+        queue->deque = deque_create(element_size, allocator);
+    }
+    else {
+        queue->capacity = QUEUE_INITIAL_CAPACITY;
+        queue->data = allocator_allocate(allocator, QUEUE_INITIAL_CAPACITY * element_size);
+    }
     return queue;
 }
 
 void queue_destroy(Queue queue) {
-    deque_destroy(queue->deque);
-    queue->allocator->deallocate(queue);
+    if (queue->storage == QUEUE_STORAGE_DEQUE) {
+        deque_destroy(queue->deque);
+    }
+    else {
+        allocator_deallocate(queue->allocator, queue->data, queue->capacity * queue->elem_size);
+    }
+    allocator_deallocate(queue->allocator, queue, sizeof(struct Queue));
 }
 
 bool queue_empty(const Queue queue) {
-    return deque_empty(queue->deque);
+    return queue_size(queue) == 0;
 }
 
 size_t queue_size(const Queue queue) {
-    return deque_size(queue->deque);
+    if (queue->storage == QUEUE_STORAGE_DEQUE) {
+        return deque_size(queue->deque);
+    }
+    return queue->size;
 }
 
 void queue_front(const Queue queue, void* out) {
-    deque_front(queue->deque, out);
+    if (queue->storage == QUEUE_STORAGE_DEQUE) {
+        deque_front(queue->deque, out);
+        return;
+    }
+    memcpy(out, ring_at(queue, 0), queue->elem_size);
 }
 
 void queue_back(const Queue queue, void* out) {
-    deque_back(queue->deque, out);
+    if (queue->storage == QUEUE_STORAGE_DEQUE) {
+        deque_back(queue->deque, out);
+        return;
+    }
+    memcpy(out, ring_at(queue, queue->size - 1), queue->elem_size);
 }
 
 void queue_push(Queue queue, const void* element) {
-    deque_push_back(queue->deque, element);
+    if (queue->storage == QUEUE_STORAGE_DEQUE) {
+        deque_push_back(queue->deque, element);
+        return;
+    }
+    ring_reserve(queue, 1);
+    memcpy(ring_at(queue, queue->size), element, queue->elem_size);
+    queue->size++;
 }
 
 void queue_pop(Queue queue) {
-    deque_pop_front(queue->deque);
+    if (queue->storage == QUEUE_STORAGE_DEQUE) {
+        deque_pop_front(queue->deque);
+        return;
+    }
+    if (queue->size == 0) return;
+    queue->head = (queue->head + 1) & (queue->capacity - 1);
+    queue->size--;
+}
+
+void queue_push_n(Queue queue, const void* elements, size_t count) {
+    const char* src = elements;
+    if (queue->storage == QUEUE_STORAGE_DEQUE) {
+        for (size_t i = 0; i < count; i++) {
+            deque_push_back(queue->deque, src + i * queue->elem_size);
+        }
+        return;
+    }
+
+    ring_reserve(queue, count);
+    // 从队尾写到缓冲区末尾，剩下的回绕到开头
+    size_t tail = (queue->head + queue->size) & (queue->capacity - 1);
+    size_t first = queue->capacity - tail < count ? queue->capacity - tail : count;
+    memcpy(queue->data + tail * queue->elem_size, src, first * queue->elem_size);
+    memcpy(queue->data, src + first * queue->elem_size, (count - first) * queue->elem_size);
+    queue->size += count;
+}
+
+size_t queue_pop_n(Queue queue, void* out, size_t count) {
+    char* dest = out;
+    if (queue->storage == QUEUE_STORAGE_DEQUE) {
+        size_t n = 0;
+        for (; n < count && !deque_empty(queue->deque); n++) {
+            if (dest) deque_front(queue->deque, dest + n * queue->elem_size);
+            deque_pop_front(queue->deque);
+        }
+        return n;
+    }
+
+    if (count > queue->size) count = queue->size;
+    if (dest) {
+        size_t first = queue->capacity - queue->head < count ? queue->capacity - queue->head : count;
+        memcpy(dest, queue->data + queue->head * queue->elem_size, first * queue->elem_size);
+        memcpy(dest + first * queue->elem_size, queue->data, (count - first) * queue->elem_size);
+    }
+    queue->head = (queue->head + count) & (queue->capacity - 1);
+    queue->size -= count;
+    return count;
+}
+
+Span queue_peek_span(const Queue queue) {
+    if (queue->storage == QUEUE_STORAGE_DEQUE) {
+        size_t cursor = 0;
+        Span segment = span_make(NULL, 0, queue->elem_size);
+        deque_next_segment(queue->deque, &cursor, &segment);
+        return segment;
+    }
+
+    size_t count = queue->capacity - queue->head < queue->size ? queue->capacity - queue->head : queue->size;
+    return span_make(ring_at(queue, 0), count, queue->elem_size);
+}
+
+// 环形缓冲区迭代器：到缓冲区末尾时回绕，不做除法
+static void ring_iterator_get(Iterator it, void* dest) {
+    memcpy(dest, it.ptr, it.elem_size);
+}
+
+static void ring_iterator_set(Iterator it, const void* value) {
+    memcpy(it.ptr, value, it.elem_size);
+}
+
+static Iterator ring_iterator_next(Iterator it) {
+    Queue queue = it.container;
+    char* ptr = (char*)it.ptr + it.elem_size;
+    if (ptr == queue->data + queue->capacity * it.elem_size) {
+        ptr = queue->data;
+    }
+    it.ptr = ptr;
+    return it;
+}
+
+static Iterator ring_iterator_prev(Iterator it) {
+    Queue queue = it.container;
+    char* ptr = it.ptr;
+    if (ptr == queue->data) {
+        ptr = queue->data + queue->capacity * it.elem_size;
+    }
+    it.ptr = ptr - it.elem_size;
+    return it;
+}
+
+// 指向第index个元素的迭代器；index为size时是结束位置，为-1时是首元素之前的位置
+// 缓冲区总留有空位，这两个位置都不会与有效元素重合
+static Iterator ring_iterator(Queue queue, size_t index, bool reverse) {
+    return (Iterator) {
+        .ptr = ring_at(queue, index),
+            .container = queue,
+            .elem_size = queue->elem_size,
+            .next = reverse ? ring_iterator_prev : ring_iterator_next,
+            .prev = reverse ? ring_iterator_next : ring_iterator_prev,
+            .get = ring_iterator_get,
+            .set = ring_iterator_set
+    };
 }
 
 Iterator queue_begin(Queue queue) {
-    return deque_begin(queue->deque);
+    if (queue->storage == QUEUE_STORAGE_DEQUE) {
+        return deque_begin(queue->deque);
+    }
+    return ring_iterator(queue, 0, false);
 }
 
 Iterator queue_end(Queue queue) {
-    return deque_end(queue->deque);
+    if (queue->storage == QUEUE_STORAGE_DEQUE) {
+        return deque_end(queue->deque);
+    }
+    return ring_iterator(queue, queue->size, false);
 }
 
 Iterator queue_rbegin(Queue queue) {
-    return deque_rbegin(queue->deque);
+    if (queue->storage == QUEUE_STORAGE_DEQUE) {
+        return deque_rbegin(queue->deque);
+    }
+    return ring_iterator(queue, queue->size - 1, true);
 }
 
 Iterator queue_rend(Queue queue) {
-    return deque_rend(queue->deque);
-}
\ No newline at end of file
+    if (queue->storage == QUEUE_STORAGE_DEQUE) {
+        return deque_rend(queue->deque);
+    }
+    return ring_iterator(queue, (size_t)-1, true);
+}
@@ -3,8 +3,15 @@
 #include "deque.h"
 typedef struct Queue* Queue;
 
+// 底层存储
+typedef enum {
+    QUEUE_STORAGE_RING,   // 2的幂容量的环形缓冲区，下标用掩码计算，满时容量翻倍（默认）
+    QUEUE_STORAGE_DEQUE   // 分块的deque，扩容时不移动已有元素
+} QueueStorage;
+
 // 创建和销毁
 API Queue queue_create(size_t element_size, Allocator* allocator);
+API Queue queue_create_with_storage(size_t element_size, QueueStorage storage, Allocator* allocator);
 API void queue_destroy(Queue queue);
 
 // 容量相关
@@ -19,8 +26,18 @@ API void queue_back(const Queue queue, void* out);
 API void queue_push(Queue queue, const void* element);
 API void queue_pop(Queue queue);
 
+// 批量入队count个连续存放的元素，环形缓冲区最多两次memcpy
+API void queue_push_n(Queue queue, const void* elements, size_t count);
+
+// 批量出队最多count个元素复制到out（out为NULL时直接丢弃），返回实际出队的数量
+API size_t queue_pop_n(Queue queue, void* out, size_t count);
+
+// 获取从队头开始的一段连续元素，不复制；处理完后用queue_pop_n(queue, NULL, n)出队
+// 队列为空时count为0，返回的视图在下一次入队或出队前有效
+API Span queue_peek_span(const Queue queue);
+
 // 迭代器
 API Iterator queue_begin(Queue queue);
 API Iterator queue_end(Queue queue);
 API Iterator queue_rbegin(Queue queue);
-API Iterator queue_rend(Queue queue);
\ No newline at end of file
+API Iterator queue_rend(Queue queue);
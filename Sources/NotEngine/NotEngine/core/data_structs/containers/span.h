@@ -0,0 +1,31 @@
+﻿#pragma once
+#include <stddef.h>
+#include "typedefs.h"
+
+// 连续内存视图，不拥有内存
+// stride为相邻元素的字节间距；会移动或复制元素的算法要求stride等于元素大小
+typedef struct Span {
+    void* data;     // 首元素地址
+    size_t count;   // 元素个数
+    size_t stride;  // 相邻元素的字节间距
+} Span;
+
+static inline Span span_make(void* data, size_t count, size_t stride) {
+    Span span = { .data = data, .count = count, .stride = stride };
+    return span;
+}
+
+// 获取第index个元素的地址
+static inline void* span_at(Span span, size_t index) {
+    return (char*)span.data + index * span.stride;
+}
+
+// 获取结束位置（最后一个元素之后）
+static inline void* span_end(Span span) {
+    return (char*)span.data + span.count * span.stride;
+}
+
+// 获取[offset, offset + count)的子视图
+static inline Span span_subspan(Span span, size_t offset, size_t count) {
+    return span_make(span_at(span, offset), count, span.stride);
+}
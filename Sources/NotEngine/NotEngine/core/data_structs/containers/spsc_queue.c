@@ -0,0 +1,168 @@
+﻿#include <string.h>
+#include "spsc_queue.h"
+
+#define CACHE_LINE_SIZE 64
+
+// 下标单调递增，用掩码取槽位；tail - head即元素个数
+// 生产者和消费者各自缓存对方的下标，只有看起来满或空时才重新读取共享的原子变量
+struct SpscQueue {
+    // 消费者写
+    _Alignas(CACHE_LINE_SIZE) atomic_size_t head;
+    size_t cached_tail;
+    // 生产者写
+    _Alignas(CACHE_LINE_SIZE) atomic_size_t tail;
+    size_t cached_head;
+    // 阻塞策略下消费者等待not_empty，生产者等待not_full
+    _Alignas(CACHE_LINE_SIZE) WaitEvent not_empty;
+    _Alignas(CACHE_LINE_SIZE) WaitEvent not_full;
+    // 只读
+    _Alignas(CACHE_LINE_SIZE) char* data;
+    size_t mask;
+    size_t element_size;
+    WaitStrategy wait;
+    Allocator* allocator;
+};
+
+SpscQueue spsc_queue_create(size_t element_size, size_t capacity, WaitStrategy wait, Allocator* allocator) {
+    if (!allocator) allocator = get_default_allocator();
+
+    size_t rounded = 1;
+    while (rounded < capacity) {
+        rounded *= 2;
+    }
+
+    SpscQueue queue = allocator_allocate_aligned(allocator, sizeof(struct SpscQueue), CACHE_LINE_SIZE);
+    memset(queue, 0, sizeof(struct SpscQueue));
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+    wait_event_init(&queue->not_empty);
+    wait_event_init(&queue->not_full);
+    queue->data = allocator_allocate_aligned(allocator, rounded * element_size, CACHE_LINE_SIZE);
+    queue->mask = rounded - 1;
+    queue->element_size = element_size;
+    queue->wait = wait;
+    queue->allocator = allocator;
+    return queue;
+}
+
+void spsc_queue_destroy(SpscQueue queue) {
+    allocator_deallocate_aligned(queue->allocator, queue->data, (queue->mask + 1) * queue->element_size, CACHE_LINE_SIZE);
+    allocator_deallocate_aligned(queue->allocator, queue, sizeof(struct SpscQueue), CACHE_LINE_SIZE);
+}
+
+// 发布下标后唤醒可能在休眠的另一端，自旋策略下没有线程休眠
+static void notify(SpscQueue queue, WaitEvent* event) {
+    if (queue->wait == WAIT_STRATEGY_BLOCK) {
+        wait_event_notify(event, false);
+    }
+}
+
+// 在环形缓冲区的index位置复制count个元素，回绕时分两段
+static void copy_in(SpscQueue queue, size_t index, const char* src, size_t count) {
+    size_t capacity = queue->mask + 1;
+    size_t pos = index & queue->mask;
+    size_t first = capacity - pos < count ? capacity - pos : count;
+    memcpy(queue->data + pos * queue->element_size, src, first * queue->element_size);
+    memcpy(queue->data, src + first * queue->element_size, (count - first) * queue->element_size);
+}
+
+static void copy_out(SpscQueue queue, size_t index, char* dest, size_t count) {
+    size_t capacity = queue->mask + 1;
+    size_t pos = index & queue->mask;
+    size_t first = capacity - pos < count ? capacity - pos : count;
+    memcpy(dest, queue->data + pos * queue->element_size, first * queue->element_size);
+    memcpy(dest + first * queue->element_size, queue->data, (count - first) * queue->element_size);
+}
+
+size_t spsc_queue_try_push_n(SpscQueue queue, const void* elements, size_t count) {
+    size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    size_t capacity = queue->mask + 1;
+
+    if (capacity - (tail - queue->cached_head) < count) {
+        queue->cached_head = atomic_load_explicit(&queue->head, memory_order_acquire);
+    }
+    size_t space = capacity - (tail - queue->cached_head);
+    if (count > space) count = space;
+    if (count == 0) return 0;
+
+    copy_in(queue, tail, elements, count);
+    atomic_store_explicit(&queue->tail, tail + count, memory_order_release);
+    notify(queue, &queue->not_empty);
+    return count;
+}
+
+size_t spsc_queue_try_pop_n(SpscQueue queue, void* out, size_t count) {
+    size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+
+    if (queue->cached_tail - head < count) {
+        queue->cached_tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+    }
+    size_t available = queue->cached_tail - head;
+    if (count > available) count = available;
+    if (count == 0) return 0;
+
+    copy_out(queue, head, out, count);
+    atomic_store_explicit(&queue->head, head + count, memory_order_release);
+    notify(queue, &queue->not_full);
+    return count;
+}
+
+bool spsc_queue_try_push(SpscQueue queue, const void* element) {
+    return spsc_queue_try_push_n(queue, element, 1) == 1;
+}
+
+bool spsc_queue_try_pop(SpscQueue queue, void* out) {
+    return spsc_queue_try_pop_n(queue, out, 1) == 1;
+}
+
+static bool has_space(void* context) {
+    SpscQueue queue = context;
+    size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    return tail - atomic_load_explicit(&queue->head, memory_order_acquire) <= queue->mask;
+}
+
+static bool has_element(void* context) {
+    SpscQueue queue = context;
+    size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    return atomic_load_explicit(&queue->tail, memory_order_acquire) != head;
+}
+
+void spsc_queue_push_n(SpscQueue queue, const void* elements, size_t count) {
+    const char* src = elements;
+    while (count > 0) {
+        size_t pushed = spsc_queue_try_push_n(queue, src, count);
+        if (pushed == 0) {
+            wait_event_wait(&queue->not_full, queue->wait, has_space, queue);
+            continue;
+        }
+        src += pushed * queue->element_size;
+        count -= pushed;
+    }
+}
+
+size_t spsc_queue_pop_n(SpscQueue queue, void* out, size_t count) {
+    if (count == 0) return 0;
+    for (;;) {
+        size_t popped = spsc_queue_try_pop_n(queue, out, count);
+        if (popped) return popped;
+        wait_event_wait(&queue->not_empty, queue->wait, has_element, queue);
+    }
+}
+
+void spsc_queue_push(SpscQueue queue, const void* element) {
+    spsc_queue_push_n(queue, element, 1);
+}
+
+void spsc_queue_pop(SpscQueue queue, void* out) {
+    spsc_queue_pop_n(queue, out, 1);
+}
+
+size_t spsc_queue_size(const SpscQueue queue) {
+    size_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+    size_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+    return tail >= head ? tail - head : 0;
+}
+
+size_t spsc_queue_capacity(const SpscQueue queue) {
+    return queue->mask + 1;
+}
@@ -0,0 +1,43 @@
+﻿#pragma once
+#include "alloctor/allocator.h"
+#include "atomic_wait.h"
+
+// 单生产者单消费者的无锁有界环形队列
+// 只能有一个线程入队、一个线程出队；读写下标分别独占缓存行，出入队不加锁也不分配内存
+typedef struct SpscQueue* SpscQueue;
+
+// 创建队列，capacity向上取整为2的幂，wait决定阻塞版本的出入队如何等待
+API SpscQueue spsc_queue_create(size_t element_size, size_t capacity, WaitStrategy wait, Allocator* allocator);
+
+// 销毁队列，调用时两端都不能再使用
+API void spsc_queue_destroy(SpscQueue queue);
+
+// 尝试入队，队列满时返回false（生产者调用）
+API bool spsc_queue_try_push(SpscQueue queue, const void* element);
+
+// 尝试出队，队列空时返回false（消费者调用）
+API bool spsc_queue_try_pop(SpscQueue queue, void* out);
+
+// 尽量入队count个连续存放的元素，返回实际入队的数量（生产者调用）
+API size_t spsc_queue_try_push_n(SpscQueue queue, const void* elements, size_t count);
+
+// 最多出队count个元素到out，返回实际出队的数量（消费者调用）
+API size_t spsc_queue_try_pop_n(SpscQueue queue, void* out, size_t count);
+
+// 入队，队列满时按等待策略等待
+API void spsc_queue_push(SpscQueue queue, const void* element);
+
+// 出队，队列空时按等待策略等待
+API void spsc_queue_pop(SpscQueue queue, void* out);
+
+// 入队全部count个元素，空间不足时分批等待
+API void spsc_queue_push_n(SpscQueue queue, const void* elements, size_t count);
+
+// 等到至少有一个元素后最多出队count个，返回出队的数量
+API size_t spsc_queue_pop_n(SpscQueue queue, void* out, size_t count);
+
+// 当前元素个数，另一端同时操作时只是近似值
+API size_t spsc_queue_size(const SpscQueue queue);
+
+// 容量
+API size_t spsc_queue_capacity(const SpscQueue queue);
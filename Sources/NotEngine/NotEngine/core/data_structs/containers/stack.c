@@ -1,60 +1,183 @@
-﻿#include <stdio.h>
+﻿#include <string.h>
 #include "stack.h"
-#include "deque.h"
+#include "core/logger/assert.h"
+
+// data指向inline_buffer或堆上的缓冲区
 struct Stack {
-    Deque deque;  // 使用deque作为底层容器
+    char* data;
+    size_t size;
+    size_t capacity;
+    size_t element_size;
     Allocator* allocator;  // 保存创建时使用的分配器
+    _Alignas(max_align_t) char inline_buffer[];  // STACK_INLINE_CAPACITY个元素
 };
 
+static inline bool is_inline(const Stack stack) {
+    return stack->data == stack->inline_buffer;
+}
+
+static inline char* element_at(const Stack stack, size_t index) {
+    return stack->data + index * stack->element_size;
+}
+
 Stack stack_create(size_t element_size, Allocator* allocator) {
     if (!allocator) allocator = get_default_allocator();
-    Stack stack = allocator->allocate(sizeof(Stack));
+    Stack stack = allocator_allocate(allocator, sizeof(struct Stack) + STACK_INLINE_CAPACITY * element_size);
+    stack->data = stack->inline_buffer;
+    stack->size = 0;
+    stack->capacity = STACK_INLINE_CAPACITY;
+    stack->element_size = element_size;
     stack->allocator = allocator;
-    stack->deque = deque_create(element_size, allocator);
     return stack;
 }
 
 void stack_destroy(Stack stack) {
-    deque_destroy(stack->deque);
-    stack->allocator->deallocate(stack);
+    if (!is_inline(stack)) {
+        allocator_deallocate(stack->allocator, stack->data, stack->capacity * stack->element_size);
+    }
+    allocator_deallocate(stack->allocator, stack, sizeof(struct Stack) + STACK_INLINE_CAPACITY * stack->element_size);
+}
+
+void stack_reserve(Stack stack, size_t capacity) {
+    if (capacity <= stack->capacity) return;
+
+    size_t old_bytes = stack->capacity * stack->element_size;
+    size_t new_bytes = capacity * stack->element_size;
+    if (is_inline(stack)) {
+        char* data = allocator_allocate(stack->allocator, new_bytes);
+        memcpy(data, stack->data, stack->size * stack->element_size);
+        stack->data = data;
+    }
+    else {
+        stack->data = allocator_reallocate(stack->allocator, stack->data, old_bytes, new_bytes);
+    }
+    stack->capacity = capacity;
+}
+
+static void grow_to(Stack stack, size_t min_capacity) {
+    if (min_capacity <= stack->capacity) return;
+    size_t capacity = stack->capacity * 2;
+    while (capacity < min_capacity) {
+        capacity *= 2;
+    }
+    stack_reserve(stack, capacity);
 }
 
 bool stack_empty(const Stack stack) {
-    return deque_empty(stack->deque);
+    return stack->size == 0;
 }
 
 size_t stack_size(const Stack stack) {
-    return deque_size(stack->deque);
+    return stack->size;
 }
 
 void stack_top(const Stack stack, void* out) {
-    deque_back(stack->deque, out);
+    ASSERT_MSG(stack->size > 0, "stack_top on empty Stack");
+    memcpy(out, element_at(stack, stack->size - 1), stack->element_size);
+}
+
+void* stack_top_ptr(Stack stack) {
+    return stack->size ? element_at(stack, stack->size - 1) : NULL;
+}
+
+Span stack_span(Stack stack) {
+    return span_make(stack->data, stack->size, stack->element_size);
+}
+
+// 来源是否指向栈中现有的元素；扩容会使其失效，需要先记下偏移
+static bool points_into(const Stack stack, const void* elements) {
+    uintptr_t begin = (uintptr_t)stack->data;
+    uintptr_t p = (uintptr_t)elements;
+    return p >= begin && p < begin + stack->size * stack->element_size;
+}
+
+// 扩容到至少min_capacity，返回扩容后source对应的地址
+static const void* grow_keeping(Stack stack, size_t min_capacity, const void* source) {
+    if (!points_into(stack, source)) {
+        grow_to(stack, min_capacity);
+        return source;
+    }
+    size_t offset = (size_t)((const char*)source - stack->data);
+    grow_to(stack, min_capacity);
+    return stack->data + offset;
 }
 
 void stack_push(Stack stack, const void* element) {
-    deque_push_back(stack->deque, element);
+    if (stack->size == stack->capacity) element = grow_keeping(stack, stack->size + 1, element);
+    memcpy(element_at(stack, stack->size), element, stack->element_size);
+    stack->size++;
 }
 
 void stack_pop(Stack stack) {
-    deque_pop_back(stack->deque);
+    if (stack->size > 0) stack->size--;
+}
+
+void stack_push_n(Stack stack, const void* elements, size_t count) {
+    if (count == 0) return;
+    elements = grow_keeping(stack, stack->size + count, elements);
+    memcpy(element_at(stack, stack->size), elements, count * stack->element_size);
+    stack->size += count;
+}
+
+size_t stack_pop_n(Stack stack, void* out, size_t count) {
+    if (count > stack->size) count = stack->size;
+    stack->size -= count;
+    if (out) memcpy(out, element_at(stack, stack->size), count * stack->element_size);
+    return count;
+}
+
+void stack_clear(Stack stack) {
+    stack->size = 0;
+}
+
+// 迭代器操作，正向从栈顶走向栈底
+static Iterator stack_iterator_down(Iterator it) {
+    it.ptr = (char*)it.ptr - it.elem_size;
+    return it;
+}
+
+static Iterator stack_iterator_up(Iterator it) {
+    it.ptr = (char*)it.ptr + it.elem_size;
+    return it;
+}
+
+static void stack_iterator_get(Iterator it, void* dest) {
+    memcpy(dest, it.ptr, it.elem_size);
+}
+
+static void stack_iterator_set(Iterator it, const void* value) {
+    memcpy(it.ptr, value, it.elem_size);
+}
+
+static Iterator make_iterator(Stack stack, char* ptr, bool from_top) {
+    Iterator it = {
+        .ptr = ptr,
+        .container = stack,
+        .elem_size = stack->element_size,
+        .next = from_top ? stack_iterator_down : stack_iterator_up,
+        .prev = from_top ? stack_iterator_up : stack_iterator_down,
+        .get = stack_iterator_get,
+        .set = stack_iterator_set
+    };
+    return it;
 }
 
 Iterator stack_begin(Stack stack) {
-    // 从栈顶开始，即 deque 的末尾
-    return deque_rbegin(stack->deque);
+    // 从栈顶开始
+    return make_iterator(stack, stack->data + (stack->size - 1) * stack->element_size, true);
 }
 
 Iterator stack_end(Stack stack) {
-    // 栈的结束位置是 deque 的开始
-    return deque_rend(stack->deque);
+    // 栈底之前的位置
+    return make_iterator(stack, stack->data - stack->element_size, true);
 }
 
 Iterator stack_rbegin(Stack stack) {
-    // 从栈底开始，即 deque 的开始
-    return deque_begin(stack->deque);
+    // 从栈底开始
+    return make_iterator(stack, stack->data, false);
 }
 
 Iterator stack_rend(Stack stack) {
-    // 栈的反向结束位置是 deque 的末尾
-    return deque_end(stack->deque);
-}
\ No newline at end of file
+    // 栈顶之后的位置
+    return make_iterator(stack, stack->data + stack->size * stack->element_size, false);
+}
@@ -1,8 +1,16 @@
 ﻿#pragma once
-#include "deque.h"
+#include "typedefs.h"
+#include "iterator/iterator.h"
+#include "alloctor/allocator.h"
+#include "span.h"
 
+// 栈：元素连续存放，栈底在低地址
+// 前STACK_INLINE_CAPACITY个元素存放在栈对象内部，不额外分配；超出后转到堆上按两倍扩容
 typedef struct Stack* Stack;
 
+// 内联存放的元素个数
+#define STACK_INLINE_CAPACITY 16
+
 // 创建和销毁
 API Stack stack_create(size_t element_size, Allocator* allocator);
 API void stack_destroy(Stack stack);
@@ -11,13 +19,32 @@ API void stack_destroy(Stack stack);
 API bool stack_empty(const Stack stack);
 API size_t stack_size(const Stack stack);
 
+// 预留至少capacity个元素的容量
+API void stack_reserve(Stack stack, size_t capacity);
+
 // 元素访问
 API void stack_top(const Stack stack, void* out);
 
+// 获取栈顶元素的地址，不复制；栈为空时返回NULL，下次push可能使其失效
+API void* stack_top_ptr(Stack stack);
+
+// 获取从栈底到栈顶的Span视图，下次push可能使其失效
+API Span stack_span(Stack stack);
+
 // 修改器
 API void stack_push(Stack stack, const void* element);
 API void stack_pop(Stack stack);
 
+// 批量压入count个连续存放的元素，最后一个成为栈顶；只扩容和复制一次
+API void stack_push_n(Stack stack, const void* elements, size_t count);
+
+// 批量弹出最多count个元素，返回实际弹出的数量
+// out不为NULL时按从栈底到栈顶的顺序复制出来，即push_n后立即pop_n得到原顺序
+API size_t stack_pop_n(Stack stack, void* out, size_t count);
+
+// 清空，保留容量
+API void stack_clear(Stack stack);
+
 // 迭代器
 API Iterator stack_begin(Stack stack);
 API Iterator stack_end(Stack stack);
@@ -0,0 +1,118 @@
+﻿#pragma once
+#include <string.h>
+#include "core/data_structs/containers/alloctor/allocator.h"
+#include "core/data_structs/containers/span.h"
+
+// 类型化动态数组：ARRAYLIST_DEFINE(Name, T)生成结构体Name及一组Name_xxx内联函数
+// 元素直接赋值，不经过memcpy和函数指针，编译器可以内联和向量化
+// 结构体按值嵌入使用，先Name_init后Name_destroy；data可直接下标访问
+//
+//   ARRAYLIST_DEFINE(Vec3List, Vector3)
+//   Vec3List list;
+//   Vec3List_init(&list, NULL);
+//   Vec3List_push_back(&list, v);
+//   for (size_t i = 0; i < list.size; i++) list.data[i].x += 1.0f;
+//   Vec3List_destroy(&list);
+#define ARRAYLIST_DEFINE(Name, T)                                                           \
+    typedef struct Name {                                                                   \
+        T* data;                                                                            \
+        size_t size;                                                                        \
+        size_t capacity;                                                                    \
+        Allocator* allocator;                                                               \
+    } Name;                                                                                 \
+                                                                                            \
+    static inline void Name##_init(Name* list, Allocator* allocator) {                      \
+        list->data = NULL;                                                                  \
+        list->size = 0;                                                                     \
+        list->capacity = 0;                                                                 \
+        list->allocator = allocator ? allocator : get_default_allocator();                  \
+    }                                                                                       \
+                                                                                            \
+    static inline void Name##_destroy(Name* list) {                                         \
+        allocator_deallocate(list->allocator, list->data, list->capacity * sizeof(T));      \
+        list->data = NULL;                                                                  \
+        list->size = list->capacity = 0;                                                    \
+    }                                                                                       \
+                                                                                            \
+    static inline void Name##_set_capacity(Name* list, size_t capacity) {                   \
+        list->data = allocator_reallocate(list->allocator, list->data,                      \
+            list->capacity * sizeof(T), capacity * sizeof(T));                              \
+        list->capacity = capacity;                                                          \
+    }                                                                                       \
+                                                                                            \
+    static inline void Name##_reserve(Name* list, size_t capacity) {                        \
+        if (capacity > list->capacity) Name##_set_capacity(list, capacity);                 \
+    }                                                                                       \
+                                                                                            \
+    static inline void Name##_grow_to(Name* list, size_t min_capacity) {                    \
+        size_t capacity = list->capacity ? list->capacity + list->capacity / 2 : 8;         \
+        Name##_set_capacity(list, capacity > min_capacity ? capacity : min_capacity);       \
+    }                                                                                       \
+                                                                                            \
+    static inline void Name##_push_back(Name* list, T value) {                              \
+        if (list->size == list->capacity) Name##_grow_to(list, list->size + 1);             \
+        list->data[list->size++] = value;                                                   \
+    }                                                                                       \
+                                                                                            \
+    static inline void Name##_push_back_n(Name* list, const T* values, size_t count) {      \
+        if (list->size + count > list->capacity) {                                          \
+            /* values可能指向列表自身的元素，扩容后按偏移重新定位 */                        \
+            uintptr_t addr = (uintptr_t)values, begin = (uintptr_t)list->data;              \
+            bool aliased = addr >= begin && addr < begin + list->size * sizeof(T);          \
+            size_t offset = aliased ? (size_t)(values - list->data) : 0;                    \
+            Name##_grow_to(list, list->size + count);                                       \
+            if (aliased) values = list->data + offset;                                      \
+        }                                                                                   \
+        memcpy(list->data + list->size, values, count * sizeof(T));                         \
+        list->size += count;                                                                \
+    }                                                                                       \
+                                                                                            \
+    static inline T Name##_pop_back(Name* list) {                                           \
+        return list->data[--list->size];                                                    \
+    }                                                                                       \
+                                                                                            \
+    static inline T* Name##_at(Name* list, size_t index) {                                  \
+        return &list->data[index];                                                          \
+    }                                                                                       \
+                                                                                            \
+    static inline T Name##_get(const Name* list, size_t index) {                            \
+        return list->data[index];                                                           \
+    }                                                                                       \
+                                                                                            \
+    static inline void Name##_set(Name* list, size_t index, T value) {                      \
+        list->data[index] = value;                                                          \
+    }                                                                                       \
+                                                                                            \
+    static inline void Name##_insert(Name* list, size_t index, T value) {                   \
+        if (list->size == list->capacity) Name##_grow_to(list, list->size + 1);             \
+        memmove(list->data + index + 1, list->data + index,                                 \
+            (list->size - index) * sizeof(T));                                              \
+        list->data[index] = value;                                                          \
+        list->size++;                                                                       \
+    }                                                                                       \
+                                                                                            \
+    static inline void Name##_erase(Name* list, size_t index) {                             \
+        memmove(list->data + index, list->data + index + 1,                                 \
+            (list->size - index - 1) * sizeof(T));                                          \
+        list->size--;                                                                       \
+    }                                                                                       \
+                                                                                            \
+    static inline void Name##_swap_remove(Name* list, size_t index) {                       \
+        list->data[index] = list->data[--list->size];                                       \
+    }                                                                                       \
+                                                                                            \
+    static inline void Name##_clear(Name* list) {                                           \
+        list->size = 0;                                                                     \
+    }                                                                                       \
+                                                                                            \
+    static inline size_t Name##_size(const Name* list) {                                    \
+        return list->size;                                                                  \
+    }                                                                                       \
+                                                                                            \
+    static inline bool Name##_empty(const Name* list) {                                     \
+        return list->size == 0;                                                             \
+    }                                                                                       \
+                                                                                            \
+    static inline Span Name##_span(Name* list) {                                            \
+        return span_make(list->data, list->size, sizeof(T));                                \
+    }
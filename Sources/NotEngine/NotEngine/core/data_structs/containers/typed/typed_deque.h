@@ -0,0 +1,85 @@
+﻿#pragma once
+#include "core/data_structs/containers/alloctor/allocator.h"
+
+// 类型化双端队列：DEQUE_DEFINE(Name, T)生成基于环形缓冲区的Name及Name_xxx内联函数
+// 容量为2的幂，下标通过掩码回绕；扩容时元素整理为从0开始连续存放
+#define DEQUE_DEFINE(Name, T)                                                               \
+    typedef struct Name {                                                                   \
+        T* data;                                                                            \
+        size_t head;                                                                        \
+        size_t size;                                                                        \
+        size_t capacity;                                                                    \
+        Allocator* allocator;                                                               \
+    } Name;                                                                                 \
+                                                                                            \
+    static inline void Name##_init(Name* deque, Allocator* allocator) {                     \
+        deque->data = NULL;                                                                 \
+        deque->head = deque->size = deque->capacity = 0;                                    \
+        deque->allocator = allocator ? allocator : get_default_allocator();                 \
+    }                                                                                       \
+                                                                                            \
+    static inline void Name##_destroy(Name* deque) {                                        \
+        allocator_deallocate(deque->allocator, deque->data, deque->capacity * sizeof(T));   \
+        deque->data = NULL;                                                                 \
+        deque->head = deque->size = deque->capacity = 0;                                    \
+    }                                                                                       \
+                                                                                            \
+    static inline void Name##_grow(Name* deque) {                                           \
+        size_t capacity = deque->capacity ? deque->capacity * 2 : 16;                       \
+        T* data = allocator_allocate(deque->allocator, capacity * sizeof(T));               \
+        for (size_t i = 0; i < deque->size; i++) {                                          \
+            data[i] = deque->data[(deque->head + i) & (deque->capacity - 1)];               \
+        }                                                                                   \
+        allocator_deallocate(deque->allocator, deque->data, deque->capacity * sizeof(T));   \
+        deque->data = data;                                                                 \
+        deque->head = 0;                                                                    \
+        deque->capacity = capacity;                                                         \
+    }                                                                                       \
+                                                                                            \
+    static inline void Name##_push_back(Name* deque, T value) {                             \
+        if (deque->size == deque->capacity) Name##_grow(deque);                             \
+        deque->data[(deque->head + deque->size++) & (deque->capacity - 1)] = value;         \
+    }                                                                                       \
+                                                                                            \
+    static inline void Name##_push_front(Name* deque, T value) {                            \
+        if (deque->size == deque->capacity) Name##_grow(deque);                             \
+        deque->head = (deque->head - 1) & (deque->capacity - 1);                            \
+        deque->data[deque->head] = value;                                                   \
+        deque->size++;                                                                      \
+    }                                                                                       \
+                                                                                            \
+    static inline T Name##_pop_front(Name* deque) {                                         \
+        T value = deque->data[deque->head];                                                 \
+        deque->head = (deque->head + 1) & (deque->capacity - 1);                            \
+        deque->size--;                                                                      \
+        return value;                                                                       \
+    }                                                                                       \
+                                                                                            \
+    static inline T Name##_pop_back(Name* deque) {                                          \
+        deque->size--;                                                                      \
+        return deque->data[(deque->head + deque->size) & (deque->capacity - 1)];            \
+    }                                                                                       \
+                                                                                            \
+    static inline T* Name##_at(Name* deque, size_t index) {                                 \
+        return &deque->data[(deque->head + index) & (deque->capacity - 1)];                 \
+    }                                                                                       \
+                                                                                            \
+    static inline T* Name##_front(Name* deque) {                                            \
+        return &deque->data[deque->head];                                                   \
+    }                                                                                       \
+                                                                                            \
+    static inline T* Name##_back(Name* deque) {                                             \
+        return Name##_at(deque, deque->size - 1);                                           \
+    }                                                                                       \
+                                                                                            \
+    static inline void Name##_clear(Name* deque) {                                          \
+        deque->head = deque->size = 0;                                                      \
+    }                                                                                       \
+                                                                                            \
+    static inline size_t Name##_size(const Name* deque) {                                   \
+        return deque->size;                                                                 \
+    }                                                                                       \
+                                                                                            \
+    static inline bool Name##_empty(const Name* deque) {                                    \
+        return deque->size == 0;                                                            \
+    }
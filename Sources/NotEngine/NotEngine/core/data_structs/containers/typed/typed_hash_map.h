@@ -0,0 +1,142 @@
+﻿#pragma once
+#include <string.h>
+#include "core/data_structs/containers/alloctor/allocator.h"
+
+// 类型化哈希表：HASHMAP_DEFINE(Name, K, V, hash, eq)生成结构体Name及Name_xxx内联函数
+// hash为size_t hash(K key)，eq为bool eq(K a, K b)，可以是static inline函数或宏，调用处直接内联
+// 开放寻址+线性探测，键、占用标记和值放在同一个槽位里，探测比较键时不必再访问别的数组；
+// 删除使用后移法，不留墓碑
+// 示例中的hash_u32来自hash/hash.h
+//
+//   static inline size_t entity_hash(uint32_t k) { return (size_t)hash_u32(k, HASH_DEFAULT_SEED); }
+//   static inline bool entity_equal(uint32_t a, uint32_t b) { return a == b; }
+//   HASHMAP_DEFINE(EntityMap, uint32_t, Matrix4x4, entity_hash, entity_equal)
+//
+// 遍历：size_t cursor = 0; uint32_t* k; Matrix4x4* v; while (EntityMap_next(&map, &cursor, &k, &v)) {...}
+#define TYPED_HASHMAP_INITIAL_CAPACITY 16
+
+#define HASHMAP_DEFINE(Name, K, V, hash, eq)                                                \
+    typedef struct Name##Slot {                                                             \
+        K key;                                                                              \
+        bool used;                                                                          \
+        V value;                                                                            \
+    } Name##Slot;                                                                           \
+                                                                                            \
+    typedef struct Name {                                                                   \
+        Name##Slot* slots;                                                                  \
+        size_t size;                                                                        \
+        size_t capacity;                                                                    \
+        Allocator* allocator;                                                               \
+    } Name;                                                                                 \
+                                                                                            \
+    static inline void Name##_init(Name* map, Allocator* allocator) {                       \
+        map->slots = NULL;                                                                  \
+        map->size = map->capacity = 0;                                                      \
+        map->allocator = allocator ? allocator : get_default_allocator();                   \
+    }                                                                                       \
+                                                                                            \
+    static inline void Name##_destroy(Name* map) {                                          \
+        allocator_deallocate(map->allocator, map->slots,                                    \
+            map->capacity * sizeof(Name##Slot));                                            \
+        Name##_init(map, map->allocator);                                                   \
+    }                                                                                       \
+                                                                                            \
+    static inline size_t Name##_slot(const Name* map, K key) {                              \
+        size_t mask = map->capacity - 1;                                                    \
+        size_t i = (size_t)(hash(key)) & mask;                                              \
+        while (map->slots[i].used && !(eq(map->slots[i].key, key))) {                       \
+            i = (i + 1) & mask;                                                             \
+        }                                                                                   \
+        return i;                                                                           \
+    }                                                                                       \
+                                                                                            \
+    static inline void Name##_rehash(Name* map, size_t capacity) {                          \
+        Name##Slot* old = map->slots;                                                       \
+        size_t old_capacity = map->capacity;                                                \
+        map->slots = allocator_allocate(map->allocator, capacity * sizeof(Name##Slot));     \
+        for (size_t i = 0; i < capacity; i++) map->slots[i].used = false;                   \
+        map->capacity = capacity;                                                           \
+        for (size_t i = 0; i < old_capacity; i++) {                                         \
+            if (!old[i].used) continue;                                                     \
+            map->slots[Name##_slot(map, old[i].key)] = old[i];                              \
+        }                                                                                   \
+        allocator_deallocate(map->allocator, old, old_capacity * sizeof(Name##Slot));       \
+    }                                                                                       \
+                                                                                            \
+    static inline void Name##_reserve(Name* map, size_t count) {                            \
+        size_t capacity = map->capacity ? map->capacity : TYPED_HASHMAP_INITIAL_CAPACITY;   \
+        while (capacity - capacity / 4 < count) capacity *= 2;                              \
+        if (capacity > map->capacity) Name##_rehash(map, capacity);                         \
+    }                                                                                       \
+                                                                                            \
+    static inline V* Name##_find(const Name* map, K key) {                                  \
+        if (map->size == 0) return NULL;                                                    \
+        Name##Slot* slot = &map->slots[Name##_slot(map, key)];                              \
+        return slot->used ? &slot->value : NULL;                                            \
+    }                                                                                       \
+                                                                                            \
+    static inline bool Name##_get(const Name* map, K key, V* value_out) {                   \
+        V* value = Name##_find(map, key);                                                   \
+        if (!value) return false;                                                           \
+        if (value_out) *value_out = *value;                                                 \
+        return true;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    static inline bool Name##_contains(const Name* map, K key) {                            \
+        return Name##_find(map, key) != NULL;                                               \
+    }                                                                                       \
+                                                                                            \
+    static inline bool Name##_insert(Name* map, K key, V value) {                           \
+        Name##_reserve(map, map->size + 1);                                                 \
+        Name##Slot* slot = &map->slots[Name##_slot(map, key)];                              \
+        slot->value = value;                                                                \
+        if (slot->used) return false;                                                       \
+        slot->key = key;                                                                    \
+        slot->used = true;                                                                  \
+        map->size++;                                                                        \
+        return true;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    static inline size_t Name##_erase(Name* map, K key) {                                   \
+        if (map->size == 0) return 0;                                                       \
+        size_t mask = map->capacity - 1;                                                    \
+        size_t hole = Name##_slot(map, key);                                                \
+        if (!map->slots[hole].used) return 0;                                               \
+        size_t i = hole;                                                                    \
+        for (;;) {                                                                          \
+            i = (i + 1) & mask;                                                             \
+            if (!map->slots[i].used) break;                                                 \
+            size_t home = (size_t)(hash(map->slots[i].key)) & mask;                         \
+            if (((i - home) & mask) >= ((i - hole) & mask)) {                               \
+                map->slots[hole] = map->slots[i];                                           \
+                hole = i;                                                                   \
+            }                                                                               \
+        }                                                                                   \
+        map->slots[hole].used = false;                                                      \
+        map->size--;                                                                        \
+        return 1;                                                                           \
+    }                                                                                       \
+                                                                                            \
+    static inline void Name##_clear(Name* map) {                                            \
+        for (size_t i = 0; i < map->capacity; i++) map->slots[i].used = false;              \
+        map->size = 0;                                                                      \
+    }                                                                                       \
+                                                                                            \
+    static inline size_t Name##_size(const Name* map) {                                     \
+        return map->size;                                                                   \
+    }                                                                                       \
+                                                                                            \
+    static inline bool Name##_empty(const Name* map) {                                      \
+        return map->size == 0;                                                              \
+    }                                                                                       \
+                                                                                            \
+    static inline bool Name##_next(const Name* map, size_t* cursor, K** key, V** value) {   \
+        for (size_t i = *cursor; i < map->capacity; i++) {                                  \
+            if (!map->slots[i].used) continue;                                              \
+            *key = &map->slots[i].key;                                                      \
+            *value = &map->slots[i].value;                                                  \
+            *cursor = i + 1;                                                                \
+            return true;                                                                    \
+        }                                                                                   \
+        return false;                                                                       \
+    }
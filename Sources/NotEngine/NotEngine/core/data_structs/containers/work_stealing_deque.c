@@ -0,0 +1,140 @@
+﻿#include <string.h>
+#include "work_stealing_deque.h"
+
+#define CACHE_LINE_SIZE 64
+
+// 环形数组，previous串起被替换下来的旧数组
+typedef struct Array {
+    struct Array* previous;
+    size_t mask;
+    _Atomic(void*) items[];
+} Array;
+
+// top只增不减，由窃取者和所有者弹出最后一个元素时CAS推进；bottom只由所有者修改
+// 下标用有符号数：所有者pop时bottom会先减一，可能暂时小于top
+struct WorkStealingDeque {
+    _Alignas(CACHE_LINE_SIZE) _Atomic(int64_t) top;
+    _Alignas(CACHE_LINE_SIZE) _Atomic(int64_t) bottom;
+    _Atomic(Array*) array;
+    Allocator* allocator;
+};
+
+static size_t array_bytes(size_t capacity) {
+    return sizeof(Array) + capacity * sizeof(_Atomic(void*));
+}
+
+static Array* array_create(Allocator* allocator, size_t capacity) {
+    Array* array = allocator_allocate(allocator, array_bytes(capacity));
+    array->previous = NULL;
+    array->mask = capacity - 1;
+    return array;
+}
+
+static inline void* array_get(Array* array, int64_t index) {
+    return atomic_load_explicit(&array->items[(size_t)index & array->mask], memory_order_relaxed);
+}
+
+static inline void array_put(Array* array, int64_t index, void* item) {
+    atomic_store_explicit(&array->items[(size_t)index & array->mask], item, memory_order_relaxed);
+}
+
+WorkStealingDeque ws_deque_create(size_t capacity, Allocator* allocator) {
+    if (!allocator) allocator = get_default_allocator();
+
+    size_t rounded = 2;
+    while (rounded < capacity) {
+        rounded *= 2;
+    }
+
+    WorkStealingDeque deque = allocator_allocate_aligned(allocator, sizeof(struct WorkStealingDeque), CACHE_LINE_SIZE);
+    memset(deque, 0, sizeof(struct WorkStealingDeque));
+    atomic_init(&deque->top, 0);
+    atomic_init(&deque->bottom, 0);
+    atomic_init(&deque->array, array_create(allocator, rounded));
+    deque->allocator = allocator;
+    return deque;
+}
+
+void ws_deque_destroy(WorkStealingDeque deque) {
+    Array* array = atomic_load_explicit(&deque->array, memory_order_relaxed);
+    while (array) {
+        Array* previous = array->previous;
+        allocator_deallocate(deque->allocator, array, array_bytes(array->mask + 1));
+        array = previous;
+    }
+    allocator_deallocate_aligned(deque->allocator, deque, sizeof(struct WorkStealingDeque), CACHE_LINE_SIZE);
+}
+
+// 把[top, bottom)复制到两倍大的新数组后发布；旧数组中的内容不变，正在读旧数组的窃取者仍能取到正确的元素
+static Array* grow(WorkStealingDeque deque, Array* array, int64_t top, int64_t bottom) {
+    Array* bigger = array_create(deque->allocator, (array->mask + 1) * 2);
+    for (int64_t i = top; i < bottom; i++) {
+        array_put(bigger, i, array_get(array, i));
+    }
+    bigger->previous = array;
+    atomic_store_explicit(&deque->array, bigger, memory_order_release);
+    return bigger;
+}
+
+void ws_deque_push(WorkStealingDeque deque, void* item) {
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    Array* array = atomic_load_explicit(&deque->array, memory_order_relaxed);
+
+    if (bottom - top > (int64_t)array->mask) {
+        array = grow(deque, array, top, bottom);
+    }
+    array_put(array, bottom, item);
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_release);
+}
+
+bool ws_deque_pop(WorkStealingDeque deque, void** out) {
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    Array* array = atomic_load_explicit(&deque->array, memory_order_relaxed);
+
+    // 先占住bottom - 1再读top，与steal中先读top再读bottom的顺序由全屏障配对
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    if (top > bottom) {
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return false;
+    }
+
+    void* item = array_get(array, bottom);
+    if (top == bottom) {
+        // 最后一个元素，和窃取者竞争top
+        bool won = atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed);
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        if (!won) return false;
+    }
+    *out = item;
+    return true;
+}
+
+StealResult ws_deque_steal(WorkStealingDeque deque, void** out) {
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    if (top >= bottom) return STEAL_EMPTY;
+
+    // 先读出元素再CAS：CAS成功说明读取期间top没有被别人推进，读到的就是第top个元素
+    Array* array = atomic_load_explicit(&deque->array, memory_order_acquire);
+    void* item = array_get(array, top);
+    if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed)) {
+        return STEAL_ABORT;
+    }
+    *out = item;
+    return STEAL_SUCCESS;
+}
+
+size_t ws_deque_size(const WorkStealingDeque deque) {
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    return bottom > top ? (size_t)(bottom - top) : 0;
+}
+
+size_t ws_deque_capacity(const WorkStealingDeque deque) {
+    return atomic_load_explicit(&deque->array, memory_order_acquire)->mask + 1;
+}
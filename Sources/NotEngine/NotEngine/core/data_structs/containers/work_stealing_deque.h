@@ -0,0 +1,37 @@
+﻿#pragma once
+#include <stdatomic.h>
+#include <stdint.h>
+#include "alloctor/allocator.h"
+
+// 无锁工作窃取双端队列（Chase-Lev）
+// 所有者线程在底端push/pop，其他线程在顶端steal；存放任务指针
+// 满时所有者换用两倍大的环形数组，旧数组保留到销毁，窃取者读到旧数组也不会出错，扩容不阻塞窃取者
+typedef struct WorkStealingDeque* WorkStealingDeque;
+
+// 窃取结果
+typedef enum StealResult {
+    STEAL_SUCCESS,  // 取到一个元素
+    STEAL_EMPTY,    // 队列为空
+    STEAL_ABORT     // 与其他线程竞争失败，可以重试或换一个队列窃取
+} StealResult;
+
+// 创建队列，capacity为初始容量，向上取整为2的幂
+API WorkStealingDeque ws_deque_create(size_t capacity, Allocator* allocator);
+
+// 销毁队列，调用时不能有线程还在使用
+API void ws_deque_destroy(WorkStealingDeque deque);
+
+// 在底端压入，满时扩容（所有者调用）
+API void ws_deque_push(WorkStealingDeque deque, void* item);
+
+// 从底端弹出最近压入的元素，为空时返回false（所有者调用）
+API bool ws_deque_pop(WorkStealingDeque deque, void** out);
+
+// 从顶端窃取最早压入的元素（任意线程调用）
+API StealResult ws_deque_steal(WorkStealingDeque deque, void** out);
+
+// 当前元素个数，有其他线程同时操作时只是近似值
+API size_t ws_deque_size(const WorkStealingDeque deque);
+
+// 当前环形数组的容量
+API size_t ws_deque_capacity(const WorkStealingDeque deque);
@@ -0,0 +1,37 @@
+﻿#include <stdio.h>
+#include <string.h>
+#include "bench.h"
+
+typedef struct BenchEntry
+{
+    const char* name;
+    void (*run)(void);
+} BenchEntry;
+
+static const BenchEntry benches[] = {
+    { "arena", bench_arena },
+    { "thread_cache", bench_thread_cache },
+    { "hash_map", bench_hash_map },
+    { "concurrent_hash_map", bench_concurrent_hash_map },
+    { "deque", bench_deque },
+    { "spsc_queue", bench_spsc_queue },
+    { "mpmc_queue", bench_mpmc_queue },
+    { "priority_queue", bench_priority_queue },
+};
+
+bool run_benches(const char* name)
+{
+    bool found = false;
+    for (size_t i = 0; i < sizeof(benches) / sizeof(benches[0]); i++)
+    {
+        if (name && strcmp(name, benches[i].name) != 0) continue;
+        printf("== %s\n", benches[i].name);
+        benches[i].run();
+        found = true;
+    }
+    if (!found)
+    {
+        printf("Unknown benchmark: %s\n", name);
+    }
+    return found;
+}
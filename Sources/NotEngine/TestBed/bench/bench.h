@@ -0,0 +1,25 @@
+﻿#pragma once
+#include <stdbool.h>
+#include <time.h>
+
+// 性能对比用的基准测试，结果输出到stdout；数字只在同一台机器的同一次运行内有比较意义
+
+// 墙钟时间，单位毫秒；基准测试只用两次读数的差值
+static inline double bench_now_ms(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+// 运行名为name的基准测试，name为NULL时全部运行；找不到时返回false
+bool run_benches(const char* name);
+
+void bench_arena(void);
+void bench_thread_cache(void);
+void bench_hash_map(void);
+void bench_concurrent_hash_map(void);
+void bench_deque(void);
+void bench_spsc_queue(void);
+void bench_mpmc_queue(void);
+void bench_priority_queue(void);
@@ -0,0 +1,57 @@
+﻿#include <stdio.h>
+#include "core/data_structs/containers/alloctor/arena_allocator.h"
+#include "core/data_structs/containers/array_list.h"
+#include "core/data_structs/containers/hash_map.h"
+#include "bench.h"
+
+#define FRAME_COUNT 2000
+#define CONTAINERS_PER_FRAME 200
+
+// 模拟一帧内的临时容器：每帧创建CONTAINERS_PER_FRAME个小ArrayList和HashMap
+static void run_frame(Allocator* allocator, bool release)
+{
+    for (int i = 0; i < CONTAINERS_PER_FRAME; i++)
+    {
+        ArrayList list = arraylist_create(sizeof(int), allocator);
+        for (int j = 0; j < 64; j++)
+        {
+            arraylist_push_back(list, &j);
+        }
+        HashMap map = hashmap_create_u32(sizeof(int), allocator);
+        for (uint32_t j = 0; j < 32; j++)
+        {
+            hashmap_insert(map, &j, &j);
+        }
+        // arena上的容器随帧整体释放，不逐个销毁
+        if (release)
+        {
+            arraylist_destroy(list);
+            hashmap_destroy(map);
+        }
+    }
+}
+
+void bench_arena(void)
+{
+    FrameArena frame = frame_arena_create(1 << 20, NULL);
+    double start = bench_now_ms();
+    for (int f = 0; f < FRAME_COUNT; f++)
+    {
+        run_frame(frame_arena_current(frame), false);
+        frame_arena_swap(frame);
+    }
+    double arena_ms = bench_now_ms() - start;
+    frame_arena_destroy(frame);
+
+    start = bench_now_ms();
+    for (int f = 0; f < FRAME_COUNT; f++)
+    {
+        run_frame(get_default_allocator(), true);
+    }
+    double default_ms = bench_now_ms() - start;
+
+    printf("%d ArrayLists of 64 ints + %d HashMaps of 32 entries per frame\n",
+        CONTAINERS_PER_FRAME, CONTAINERS_PER_FRAME);
+    printf("  frame arena        %.3f ms/frame\n", arena_ms / FRAME_COUNT);
+    printf("  default allocator  %.3f ms/frame\n", default_ms / FRAME_COUNT);
+}
@@ -0,0 +1,127 @@
+﻿#include <stdio.h>
+#include "core/data_structs/containers/concurrent_hash_map.h"
+#include "tests/test_thread.h"
+#include "bench.h"
+
+#define KEY_COUNT (1 << 16)
+#define OPS_PER_THREAD 200000
+#define MAX_THREADS 64
+
+// 对比全局互斥锁+HashMap与64分片的ConcurrentHashMap：随机键，按比例混合读写
+typedef struct MapBench
+{
+    ConcurrentHashMap sharded;
+    HashMap global;
+    TestMutex global_lock;
+    bool use_global;
+    int read_percent;
+} MapBench;
+
+typedef struct MapWorker
+{
+    MapBench* bench;
+    uint64_t seed;
+} MapWorker;
+
+static void double_key(const void* key, void* value_out, void* user_data)
+{
+    *(uint64_t*)value_out = *(const uint64_t*)key * 2;
+}
+
+static void map_worker(void* arg)
+{
+    MapWorker* worker = arg;
+    MapBench* bench = worker->bench;
+    uint64_t random = worker->seed;
+
+    for (int i = 0; i < OPS_PER_THREAD; i++)
+    {
+        random ^= random << 13;
+        random ^= random >> 7;
+        random ^= random << 17;
+        uint64_t key = random % KEY_COUNT;
+        uint64_t value = key * 2;
+        bool read = (int)((random >> 40) % 100) < bench->read_percent;
+
+        if (bench->use_global)
+        {
+            test_mutex_lock(&bench->global_lock);
+            if (read) hashmap_get(bench->global, &key, &value);
+            else hashmap_insert(bench->global, &key, &value);
+            test_mutex_unlock(&bench->global_lock);
+        }
+        else if (read)
+        {
+            concurrent_hashmap_get(bench->sharded, &key, &value);
+        }
+        else if (i & 1)
+        {
+            concurrent_hashmap_compute_if_absent(bench->sharded, &key, double_key, NULL, &value);
+        }
+        else
+        {
+            concurrent_hashmap_insert(bench->sharded, &key, &value);
+        }
+    }
+}
+
+// 返回每秒百万次操作
+static double run_threads(MapBench* bench, int thread_count)
+{
+    bench->sharded = concurrent_hashmap_create(sizeof(uint64_t), sizeof(uint64_t),
+        hash_func_u64, key_equal_u64, CONCURRENT_HASHMAP_DEFAULT_SHARDS, NULL);
+    bench->global = hashmap_create_u64(sizeof(uint64_t), NULL);
+    // 预先放入一半的键，读操作约一半命中
+    for (uint64_t key = 0; key < KEY_COUNT; key += 2)
+    {
+        uint64_t value = key * 2;
+        concurrent_hashmap_insert(bench->sharded, &key, &value);
+        hashmap_insert(bench->global, &key, &value);
+    }
+
+    TestThread threads[MAX_THREADS];
+    MapWorker workers[MAX_THREADS];
+    int started = 0;
+    double start = bench_now_ms();
+    for (int i = 0; i < thread_count; i++)
+    {
+        workers[i].bench = bench;
+        workers[i].seed = (uint64_t)(i + 1) * 0x9E3779B97F4A7C15ull + 1;
+        if (test_thread_start(&threads[started], map_worker, &workers[i])) started++;
+    }
+    for (int i = 0; i < started; i++)
+    {
+        test_thread_join(&threads[i]);
+    }
+    double elapsed = bench_now_ms() - start;
+
+    concurrent_hashmap_destroy(bench->sharded);
+    hashmap_destroy(bench->global);
+    return started * (double)OPS_PER_THREAD / elapsed / 1e3;
+}
+
+void bench_concurrent_hash_map(void)
+{
+    static const int thread_counts[] = { 1, 4, 16, 64 };
+    static const int read_percents[] = { 100, 90, 50 };
+
+    MapBench bench;
+    test_mutex_init(&bench.global_lock);
+    printf("%d uint64 keys, %d ops per thread, Mops/s\n", KEY_COUNT, OPS_PER_THREAD);
+    printf("                           1T     4T    16T    64T\n");
+    for (int p = 0; p < 3; p++)
+    {
+        for (int mode = 0; mode < 2; mode++)
+        {
+            bench.read_percent = read_percents[p];
+            bench.use_global = mode == 0;
+            printf("  %3d%% read  %-12s", bench.read_percent, bench.use_global ? "global mutex" : "64 shards");
+            for (int t = 0; t < 4; t++)
+            {
+                printf(" %6.1f", run_threads(&bench, thread_counts[t]));
+            }
+            printf("\n");
+        }
+    }
+    test_mutex_destroy(&bench.global_lock);
+}
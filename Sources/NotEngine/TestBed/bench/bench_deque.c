@@ -0,0 +1,45 @@
+﻿#include <stdio.h>
+#include "core/data_structs/containers/deque.h"
+#include "bench.h"
+
+#define FIFO_OPS 20000000
+
+// 稳态FIFO：队列保持length个元素，每次push_back后pop_front；取3次中最快的一次，返回每秒百万次操作
+static double run_fifo(size_t length, size_t block_bytes)
+{
+    double best_ms = 0;
+    for (int round = 0; round < 3; round++)
+    {
+        Deque deque = deque_create_with_block_size(sizeof(int), block_bytes, NULL);
+        int value = 0;
+        for (size_t i = 0; i < length; i++)
+        {
+            deque_push_back(deque, &value);
+        }
+
+        double start = bench_now_ms();
+        for (int i = 0; i < FIFO_OPS; i++)
+        {
+            deque_push_back(deque, &i);
+            deque_pop_front(deque);
+        }
+        double elapsed = bench_now_ms() - start;
+        if (round == 0 || elapsed < best_ms) best_ms = elapsed;
+        deque_destroy(deque);
+    }
+    return FIFO_OPS / best_ms / 1e3;
+}
+
+void bench_deque(void)
+{
+    static const size_t lengths[] = { 1, 100, 10000 };
+
+    printf("steady-state FIFO, push_back + pop_front of int, Mops/s\n");
+    printf("  queue length   8-element blocks   %d-byte blocks\n", DEQUE_DEFAULT_BLOCK_BYTES);
+    for (int i = 0; i < 3; i++)
+    {
+        double small = run_fifo(lengths[i], 8 * sizeof(int));
+        double standard = run_fifo(lengths[i], DEQUE_DEFAULT_BLOCK_BYTES);
+        printf("  %12zu   %16.1f   %14.1f\n", lengths[i], small, standard);
+    }
+}
@@ -0,0 +1,67 @@
+﻿#include <stdio.h>
+#include "core/data_structs/containers/hash_map.h"
+#include "bench.h"
+
+// 键打散后插入，避免连续整数让探测序列过于规整
+static uint64_t bench_key(uint64_t i)
+{
+    return i * 0x9E3779B97F4A7C15ull;
+}
+
+// uint64 -> uint64，entries个元素；小表重复多轮以减小计时误差
+static void run_size(size_t entries)
+{
+    size_t rounds = entries < 10000 ? 10000 : 1;
+    double insert_ms = 0, hit_ms = 0, miss_ms = 0, erase_ms = 0;
+    uint64_t checksum = 0;
+
+    for (size_t r = 0; r < rounds; r++)
+    {
+        HashMap map = hashmap_create_u64(sizeof(uint64_t), NULL);
+        double start = bench_now_ms();
+        for (uint64_t i = 0; i < entries; i++)
+        {
+            uint64_t key = bench_key(i);
+            hashmap_insert(map, &key, &i);
+        }
+        insert_ms += bench_now_ms() - start;
+
+        start = bench_now_ms();
+        for (uint64_t i = 0; i < entries; i++)
+        {
+            uint64_t key = bench_key(i), value;
+            if (hashmap_get(map, &key, &value)) checksum += value;
+        }
+        hit_ms += bench_now_ms() - start;
+
+        start = bench_now_ms();
+        for (uint64_t i = entries; i < 2 * entries; i++)
+        {
+            uint64_t key = bench_key(i), value;
+            if (hashmap_get(map, &key, &value)) checksum += value;
+        }
+        miss_ms += bench_now_ms() - start;
+
+        start = bench_now_ms();
+        for (uint64_t i = 0; i < entries; i++)
+        {
+            uint64_t key = bench_key(i);
+            checksum += hashmap_erase(map, &key);
+        }
+        erase_ms += bench_now_ms() - start;
+        hashmap_destroy(map);
+    }
+
+    double ns_per_op = 1e6 / (double)(entries * rounds);
+    printf("  %8zu   %6.1f   %6.1f   %6.1f   %6.1f   (checksum %llu)\n", entries,
+        insert_ms * ns_per_op, hit_ms * ns_per_op, miss_ms * ns_per_op, erase_ms * ns_per_op,
+        (unsigned long long)checksum);
+}
+
+void bench_hash_map(void)
+{
+    printf("uint64 -> uint64 HashMap, ns/op\n");
+    printf("   entries   insert      hit     miss    erase\n");
+    run_size(1000);
+    run_size(1000000);
+}
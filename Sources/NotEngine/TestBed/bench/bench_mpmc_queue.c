@@ -0,0 +1,200 @@
+﻿#include <stdio.h>
+#include <stdatomic.h>
+#include "core/data_structs/containers/mpmc_queue.h"
+#include "core/data_structs/containers/queue.h"
+#include "tests/test_thread.h"
+#include "bench.h"
+
+#define ITEM_COUNT 2000000
+#define QUEUE_CAPACITY 1024
+#define BATCH 16
+#define MAX_THREADS 4
+#define STOP_ITEM (-1L)
+
+// 多生产者多消费者吞吐量：单个出入队、BATCH个一批，对比互斥锁+Queue
+typedef enum MpmcMode
+{
+    MODE_SINGLE,
+    MODE_BATCH,
+    MODE_MUTEX
+} MpmcMode;
+
+typedef struct MpmcBench
+{
+    MpmcMode mode;
+    int producers;
+    MpmcQueue queue;
+    Queue locked_queue;
+    TestMutex lock;
+    atomic_long received;
+    atomic_llong sum;
+} MpmcBench;
+
+typedef struct MpmcWorker
+{
+    MpmcBench* bench;
+    long id;
+} MpmcWorker;
+
+// 生产者id依次写入id、id + producers……，全部元素之和固定，用来检查有没有丢失或重复
+static void producer_main(void* arg)
+{
+    MpmcWorker* worker = arg;
+    MpmcBench* bench = worker->bench;
+    long stride = bench->producers;
+    long buffer[BATCH];
+
+    for (long i = worker->id; i < ITEM_COUNT;)
+    {
+        if (bench->mode == MODE_SINGLE)
+        {
+            mpmc_queue_push(bench->queue, &i);
+            i += stride;
+        }
+        else if (bench->mode == MODE_BATCH)
+        {
+            size_t count = 0;
+            for (; count < BATCH && i < ITEM_COUNT; count++, i += stride)
+            {
+                buffer[count] = i;
+            }
+            mpmc_queue_push_n(bench->queue, buffer, count);
+        }
+        else
+        {
+            test_mutex_lock(&bench->lock);
+            bool pushed = queue_size(bench->locked_queue) < QUEUE_CAPACITY;
+            if (pushed) queue_push(bench->locked_queue, &i);
+            test_mutex_unlock(&bench->lock);
+            if (pushed) i += stride;
+            else test_thread_yield();
+        }
+    }
+}
+
+// 无锁模式下每个消费者取到一个STOP_ITEM后退出；一批里多取到的STOP_ITEM放回给其他消费者
+static void consumer_main(void* arg)
+{
+    MpmcWorker* worker = arg;
+    MpmcBench* bench = worker->bench;
+    long buffer[BATCH];
+    long long sum = 0;
+    long received = 0;
+
+    for (;;)
+    {
+        size_t count = 0;
+        int stops = 0;
+        if (bench->mode == MODE_MUTEX)
+        {
+            if (atomic_load(&bench->received) >= ITEM_COUNT) break;
+            test_mutex_lock(&bench->lock);
+            if (!queue_empty(bench->locked_queue))
+            {
+                queue_front(bench->locked_queue, &buffer[0]);
+                queue_pop(bench->locked_queue);
+                count = 1;
+            }
+            test_mutex_unlock(&bench->lock);
+            if (count == 0)
+            {
+                test_thread_yield();
+                continue;
+            }
+            atomic_fetch_add(&bench->received, 1);
+        }
+        else
+        {
+            size_t popped = 1;
+            if (bench->mode == MODE_SINGLE) mpmc_queue_pop(bench->queue, buffer);
+            else popped = mpmc_queue_pop_n(bench->queue, buffer, BATCH);
+            for (size_t i = 0; i < popped; i++)
+            {
+                if (buffer[i] == STOP_ITEM) stops++;
+                else buffer[count++] = buffer[i];
+            }
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            sum += buffer[i];
+        }
+        received += (long)count;
+        if (stops > 0)
+        {
+            long stop = STOP_ITEM;
+            for (int i = 1; i < stops; i++)
+            {
+                mpmc_queue_push(bench->queue, &stop);
+            }
+            break;
+        }
+    }
+    atomic_fetch_add(&bench->sum, sum);
+}
+
+static void run_case(MpmcBench* bench, WaitStrategy strategy, int producers, int consumers)
+{
+    bench->producers = producers;
+    bench->queue = mpmc_queue_create(sizeof(long), QUEUE_CAPACITY, strategy, NULL);
+    bench->locked_queue = queue_create(sizeof(long), NULL);
+    atomic_store(&bench->received, 0);
+    atomic_store(&bench->sum, 0);
+
+    TestThread threads[MAX_THREADS * 2];
+    MpmcWorker workers[MAX_THREADS * 2];
+    double start = bench_now_ms();
+    for (int i = 0; i < producers + consumers; i++)
+    {
+        workers[i].bench = bench;
+        workers[i].id = i;
+        test_thread_start(&threads[i], i < producers ? producer_main : consumer_main, &workers[i]);
+    }
+    for (int i = 0; i < producers; i++)
+    {
+        test_thread_join(&threads[i]);
+    }
+    if (bench->mode != MODE_MUTEX)
+    {
+        long stop = STOP_ITEM;
+        for (int i = 0; i < consumers; i++)
+        {
+            mpmc_queue_push(bench->queue, &stop);
+        }
+    }
+    for (int i = producers; i < producers + consumers; i++)
+    {
+        test_thread_join(&threads[i]);
+    }
+    double elapsed = bench_now_ms() - start;
+
+    long long expected = (long long)(ITEM_COUNT - 1) * ITEM_COUNT / 2;
+    printf(" %6.1f%s", ITEM_COUNT / elapsed / 1e3, atomic_load(&bench->sum) == expected ? "" : " BAD");
+    mpmc_queue_destroy(bench->queue);
+    queue_destroy(bench->locked_queue);
+}
+
+static void run_row(MpmcBench* bench, MpmcMode mode, WaitStrategy strategy, const char* name)
+{
+    bench->mode = mode;
+    printf("  %-22s", name);
+    for (int threads = 1; threads <= MAX_THREADS; threads *= 2)
+    {
+        run_case(bench, strategy, threads, threads);
+    }
+    printf("\n");
+}
+
+void bench_mpmc_queue(void)
+{
+    MpmcBench bench;
+    test_mutex_init(&bench.lock);
+    printf("MpmcQueue, %d longs, capacity %d, M/s for producers x consumers\n", ITEM_COUNT, QUEUE_CAPACITY);
+    printf("  %-22s    1x1    2x2    4x4\n", "");
+    run_row(&bench, MODE_SINGLE, WAIT_STRATEGY_SPIN, "mpmc single, spin");
+    run_row(&bench, MODE_BATCH, WAIT_STRATEGY_SPIN, "mpmc batch 16, spin");
+    run_row(&bench, MODE_SINGLE, WAIT_STRATEGY_BLOCK, "mpmc single, block");
+    run_row(&bench, MODE_BATCH, WAIT_STRATEGY_BLOCK, "mpmc batch 16, block");
+    run_row(&bench, MODE_MUTEX, WAIT_STRATEGY_SPIN, "mutex + Queue");
+    test_mutex_destroy(&bench.lock);
+}
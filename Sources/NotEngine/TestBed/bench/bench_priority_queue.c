@@ -0,0 +1,112 @@
+﻿#include <stdio.h>
+#include <stdlib.h>
+#include "core/data_structs/containers/priority_queue.h"
+#include "core/data_structs/containers/array_list.h"
+#include "bench.h"
+
+// 迭代器堆每次交换都要线性前进迭代器，只能测小规模
+#define SMALL_COUNT 2000
+#define LARGE_COUNT 1000000
+
+static int compare_int(const void* a, const void* b)
+{
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// 固定种子的线性同余序列，各平台结果一致
+static int* random_ints(size_t count)
+{
+    int* values = malloc(count * sizeof(int));
+    unsigned int state = 7;
+    for (size_t i = 0; i < count; i++)
+    {
+        state = state * 1103515245u + 12345u;
+        values[i] = (int)(state >> 1);
+    }
+    return values;
+}
+
+// ArrayList上的push_heap/pop_heap/make_heap，返回弹出元素之和用于核对
+static long long run_iterator_heap(const int* values, size_t count)
+{
+    ArrayList list = arraylist_create(sizeof(int), NULL);
+    double start = bench_now_ms();
+    for (size_t i = 0; i < count; i++)
+    {
+        arraylist_push_back(list, &values[i]);
+        push_heap(arraylist_begin(list), arraylist_end(list), compare_int);
+    }
+    double pushed = bench_now_ms();
+    long long sum = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        int top;
+        arraylist_get(list, 0, &top);
+        sum += top;
+        pop_heap(arraylist_begin(list), arraylist_end(list), compare_int);
+        arraylist_pop_back(list, &top);
+    }
+    double popped = bench_now_ms();
+    arraylist_push_back_n(list, values, count);
+    make_heap(arraylist_begin(list), arraylist_end(list), compare_int);
+    double heapified = bench_now_ms();
+    arraylist_destroy(list);
+
+    printf("  push_heap/pop_heap     %10.1f %10.1f %10.1f (make_heap)\n",
+        pushed - start, popped - pushed, heapified - popped);
+    return sum;
+}
+
+static long long run_priority_queue(const int* values, size_t count, size_t arity)
+{
+    PriorityQueue pq = priority_queue_create(sizeof(int), arity, compare_int, NULL);
+    double start = bench_now_ms();
+    for (size_t i = 0; i < count; i++)
+    {
+        priority_queue_push(pq, &values[i]);
+    }
+    double pushed = bench_now_ms();
+    long long sum = 0;
+    int top;
+    while (priority_queue_pop(pq, &top))
+    {
+        sum += top;
+    }
+    double popped = bench_now_ms();
+    // clear重置句柄空闲链表，否则push_n会按弹出顺序打乱复用句柄，测到的是随机写入而不是建堆
+    priority_queue_clear(pq);
+    double cleared = bench_now_ms();
+    priority_queue_push_n(pq, values, count, NULL);
+    double heapified = bench_now_ms();
+    priority_queue_destroy(pq);
+
+    printf("  PriorityQueue, %zu-ary  %10.1f %10.1f %10.1f\n",
+        arity, pushed - start, popped - pushed, heapified - cleared);
+    return sum;
+}
+
+void bench_priority_queue(void)
+{
+    int* values = random_ints(LARGE_COUNT);
+
+    printf("%d random ints, ms\n", SMALL_COUNT);
+    printf("  %-22s %10s %10s %10s\n", "", "push", "pop", "heapify");
+    long long expected = run_iterator_heap(values, SMALL_COUNT);
+    for (size_t arity = 2; arity <= 4; arity += 2)
+    {
+        if (run_priority_queue(values, SMALL_COUNT, arity) != expected)
+        {
+            printf("  BAD: %zu-ary pop order differs from pop_heap\n", arity);
+        }
+    }
+
+    printf("%d random ints, ms\n", LARGE_COUNT);
+    printf("  %-22s %10s %10s %10s\n", "", "push", "pop", "heapify");
+    for (size_t arity = 2; arity <= 4; arity += 2)
+    {
+        run_priority_queue(values, LARGE_COUNT, arity);
+    }
+    free(values);
+}
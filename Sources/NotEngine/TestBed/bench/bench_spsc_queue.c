@@ -0,0 +1,139 @@
+﻿#include <stdio.h>
+#include "core/data_structs/containers/spsc_queue.h"
+#include "core/data_structs/containers/queue.h"
+#include "tests/test_thread.h"
+#include "bench.h"
+
+#define PING_PONG_ROUNDS 20000
+#define THROUGHPUT_ITEMS 20000000
+#define QUEUE_CAPACITY 1024
+#define MAX_BATCH 64
+
+// 单生产者单消费者：往返延迟与吞吐量，对比互斥锁+Queue
+typedef struct SpscBench
+{
+    SpscQueue request;
+    SpscQueue reply;
+    size_t batch;
+    Queue locked_queue;
+    TestMutex lock;
+} SpscBench;
+
+// 把request中的每个元素原样送回reply
+static void echo_main(void* arg)
+{
+    SpscBench* bench = arg;
+    for (int i = 0; i < PING_PONG_ROUNDS; i++)
+    {
+        int value;
+        spsc_queue_pop(bench->request, &value);
+        spsc_queue_push(bench->reply, &value);
+    }
+}
+
+static void producer_main(void* arg)
+{
+    SpscBench* bench = arg;
+    int buffer[MAX_BATCH] = { 0 };
+    if (bench->batch > 1)
+    {
+        for (long i = 0; i < THROUGHPUT_ITEMS; i += (long)bench->batch)
+        {
+            spsc_queue_push_n(bench->request, buffer, bench->batch);
+        }
+    }
+    else
+    {
+        for (long i = 0; i < THROUGHPUT_ITEMS; i++)
+        {
+            spsc_queue_push(bench->request, &buffer[0]);
+        }
+    }
+}
+
+// 互斥锁保护的Queue，同样限制在QUEUE_CAPACITY个元素以内
+static void locked_producer_main(void* arg)
+{
+    SpscBench* bench = arg;
+    for (int i = 0; i < THROUGHPUT_ITEMS; i++)
+    {
+        for (;;)
+        {
+            test_mutex_lock(&bench->lock);
+            bool pushed = queue_size(bench->locked_queue) < QUEUE_CAPACITY;
+            if (pushed) queue_push(bench->locked_queue, &i);
+            test_mutex_unlock(&bench->lock);
+            if (pushed) break;
+            test_thread_yield();
+        }
+    }
+}
+
+static void run_strategy(SpscBench* bench, WaitStrategy strategy, const char* name)
+{
+    bench->request = spsc_queue_create(sizeof(int), QUEUE_CAPACITY, strategy, NULL);
+    bench->reply = spsc_queue_create(sizeof(int), QUEUE_CAPACITY, strategy, NULL);
+
+    TestThread thread;
+    test_thread_start(&thread, echo_main, bench);
+    double start = bench_now_ms();
+    for (int i = 0; i < PING_PONG_ROUNDS; i++)
+    {
+        int value = i;
+        spsc_queue_push(bench->request, &value);
+        spsc_queue_pop(bench->reply, &value);
+    }
+    double elapsed = bench_now_ms() - start;
+    test_thread_join(&thread);
+    printf("  %-5s ping-pong round trip    %8.2f us\n", name, elapsed * 1e3 / PING_PONG_ROUNDS);
+
+    for (bench->batch = 1; bench->batch <= MAX_BATCH; bench->batch *= MAX_BATCH)
+    {
+        test_thread_start(&thread, producer_main, bench);
+        start = bench_now_ms();
+        int buffer[MAX_BATCH];
+        long received = 0;
+        while (received < THROUGHPUT_ITEMS)
+        {
+            received += (long)spsc_queue_pop_n(bench->request, buffer, MAX_BATCH);
+        }
+        elapsed = bench_now_ms() - start;
+        test_thread_join(&thread);
+        printf("  %-5s throughput, push_n %-2zu   %8.1f M/s\n", name, bench->batch,
+            THROUGHPUT_ITEMS / elapsed / 1e3);
+    }
+
+    spsc_queue_destroy(bench->request);
+    spsc_queue_destroy(bench->reply);
+}
+
+void bench_spsc_queue(void)
+{
+    SpscBench bench;
+    printf("SpscQueue of int, capacity %d, pop_n up to %d\n", QUEUE_CAPACITY, MAX_BATCH);
+    run_strategy(&bench, WAIT_STRATEGY_SPIN, "spin");
+    run_strategy(&bench, WAIT_STRATEGY_BLOCK, "block");
+
+    bench.locked_queue = queue_create(sizeof(int), NULL);
+    test_mutex_init(&bench.lock);
+    TestThread thread;
+    test_thread_start(&thread, locked_producer_main, &bench);
+    double start = bench_now_ms();
+    long received = 0;
+    while (received < THROUGHPUT_ITEMS)
+    {
+        test_mutex_lock(&bench.lock);
+        while (!queue_empty(bench.locked_queue))
+        {
+            queue_pop(bench.locked_queue);
+            received++;
+        }
+        test_mutex_unlock(&bench.lock);
+        if (received < THROUGHPUT_ITEMS) test_thread_yield();
+    }
+    double elapsed = bench_now_ms() - start;
+    test_thread_join(&thread);
+    printf("  mutex + Queue throughput       %8.1f M/s\n", THROUGHPUT_ITEMS / elapsed / 1e3);
+    test_mutex_destroy(&bench.lock);
+    queue_destroy(bench.locked_queue);
+}
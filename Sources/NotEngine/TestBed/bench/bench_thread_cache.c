@@ -0,0 +1,104 @@
+﻿#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include "core/data_structs/containers/alloctor/thread_cache_allocator.h"
+#include "tests/test_thread.h"
+#include "bench.h"
+
+#define OPS_PER_THREAD 1000000
+#define MAX_THREADS 8
+#define LIVE_BLOCKS 64
+#define HANDOFF_SLOTS 256
+
+// 每个线程随机分配和释放16~527字节的块，每16次操作把一个块交给其他线程释放
+typedef struct AllocBench
+{
+    Allocator* allocator;
+    _Atomic(void*) handoff[HANDOFF_SLOTS];
+} AllocBench;
+
+typedef struct AllocWorker
+{
+    AllocBench* bench;
+    unsigned seed;
+} AllocWorker;
+
+static void alloc_worker(void* arg)
+{
+    AllocWorker* worker = arg;
+    Allocator* allocator = worker->bench->allocator;
+    unsigned random = worker->seed;
+    void* live[LIVE_BLOCKS] = { 0 };
+    size_t sizes[LIVE_BLOCKS] = { 0 };
+
+    for (int i = 0; i < OPS_PER_THREAD; i++)
+    {
+        random = random * 1103515245u + 12345u;
+        int k = (random >> 16) & (LIVE_BLOCKS - 1);
+        size_t size = 16 + (random >> 8) % 512;
+        if (live[k])
+        {
+            allocator_deallocate(allocator, live[k], sizes[k]);
+        }
+        live[k] = allocator_allocate(allocator, size);
+        sizes[k] = size;
+        memset(live[k], 1, size);
+
+        if ((i & 15) == 0)
+        {
+            void* block = allocator_allocate(allocator, 64);
+            void* old = atomic_exchange(&worker->bench->handoff[(random >> 4) % HANDOFF_SLOTS], block);
+            if (old) allocator_deallocate(allocator, old, 64);
+        }
+    }
+    for (int k = 0; k < LIVE_BLOCKS; k++)
+    {
+        if (live[k]) allocator_deallocate(allocator, live[k], sizes[k]);
+    }
+}
+
+// 返回每秒百万次操作
+static double run_threads(Allocator* allocator, int thread_count)
+{
+    AllocBench bench;
+    bench.allocator = allocator;
+    for (int i = 0; i < HANDOFF_SLOTS; i++)
+    {
+        atomic_init(&bench.handoff[i], NULL);
+    }
+
+    TestThread threads[MAX_THREADS];
+    AllocWorker workers[MAX_THREADS];
+    int started = 0;
+    double start = bench_now_ms();
+    for (int i = 0; i < thread_count; i++)
+    {
+        workers[i].bench = &bench;
+        workers[i].seed = (unsigned)i * 7919u + 1u;
+        if (test_thread_start(&threads[started], alloc_worker, &workers[i])) started++;
+    }
+    for (int i = 0; i < started; i++)
+    {
+        test_thread_join(&threads[i]);
+    }
+    double elapsed = bench_now_ms() - start;
+
+    for (int i = 0; i < HANDOFF_SLOTS; i++)
+    {
+        void* block = atomic_exchange(&bench.handoff[i], NULL);
+        if (block) allocator_deallocate(allocator, block, 64);
+    }
+    return started * (double)OPS_PER_THREAD / elapsed / 1e3;
+}
+
+void bench_thread_cache(void)
+{
+    printf("random 16-527 byte alloc/free, 1/16 of blocks freed by another thread, Mop/s\n");
+    printf("  threads   system   thread-cache\n");
+    for (int threads = 1; threads <= MAX_THREADS; threads *= 2)
+    {
+        double system = run_threads(get_system_allocator(), threads);
+        double cached = run_threads(thread_cache_allocator_get(), threads);
+        printf("  %7d   %6.1f   %12.1f\n", threads, system, cached);
+    }
+}
@@ -4,12 +4,25 @@
 #define _CRTDBG_MAP_ALLOC
 #include <crtdbg.h>
 #include <string.h>
+#include "tests/tests.h"
+#include "bench/bench.h"
 
 
-int main(void)
+int main(int argc, char** argv)
 {
     _CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
 
     logger_add_console_callback();
+
+    // TestBed test：运行容器压力测试
+    if (argc > 1 && strcmp(argv[1], "test") == 0)
+    {
+        return run_tests() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    // TestBed bench [名称]：运行基准测试，不指定名称时全部运行
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        return run_benches(argc > 2 ? argv[2] : NULL) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
     return EXIT_SUCCESS;
 }
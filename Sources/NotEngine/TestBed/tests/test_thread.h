@@ -0,0 +1,113 @@
+﻿#pragma once
+#include <stdbool.h>
+
+// 测试用的最小线程封装：Windows使用CreateThread，其他平台使用pthreads
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+typedef struct TestThread
+{
+#ifdef _WIN32
+    HANDLE handle;
+#else
+    pthread_t handle;
+#endif
+    void (*func)(void* arg);
+    void* arg;
+} TestThread;
+
+#ifdef _WIN32
+static DWORD WINAPI test_thread_entry(LPVOID param)
+{
+    TestThread* thread = param;
+    thread->func(thread->arg);
+    return 0;
+}
+#else
+static void* test_thread_entry(void* param)
+{
+    TestThread* thread = param;
+    thread->func(thread->arg);
+    return NULL;
+}
+#endif
+
+// 启动线程，thread在test_thread_join之前必须保持有效
+static inline bool test_thread_start(TestThread* thread, void (*func)(void* arg), void* arg)
+{
+    thread->func = func;
+    thread->arg = arg;
+#ifdef _WIN32
+    thread->handle = CreateThread(NULL, 0, test_thread_entry, thread, 0, NULL);
+    return thread->handle != NULL;
+#else
+    return pthread_create(&thread->handle, NULL, test_thread_entry, thread) == 0;
+#endif
+}
+
+static inline void test_thread_join(TestThread* thread)
+{
+#ifdef _WIN32
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+#else
+    pthread_join(thread->handle, NULL);
+#endif
+}
+
+// 互斥锁，用于和无锁或分片实现做对比
+#ifdef _WIN32
+typedef CRITICAL_SECTION TestMutex;
+#else
+typedef pthread_mutex_t TestMutex;
+#endif
+
+static inline void test_mutex_init(TestMutex* mutex)
+{
+#ifdef _WIN32
+    InitializeCriticalSection(mutex);
+#else
+    pthread_mutex_init(mutex, NULL);
+#endif
+}
+
+static inline void test_mutex_destroy(TestMutex* mutex)
+{
+#ifdef _WIN32
+    DeleteCriticalSection(mutex);
+#else
+    pthread_mutex_destroy(mutex);
+#endif
+}
+
+static inline void test_mutex_lock(TestMutex* mutex)
+{
+#ifdef _WIN32
+    EnterCriticalSection(mutex);
+#else
+    pthread_mutex_lock(mutex);
+#endif
+}
+
+static inline void test_mutex_unlock(TestMutex* mutex)
+{
+#ifdef _WIN32
+    LeaveCriticalSection(mutex);
+#else
+    pthread_mutex_unlock(mutex);
+#endif
+}
+
+// 让出CPU，忙等的线程在单核机器上也能让其他线程推进
+static inline void test_thread_yield(void)
+{
+#ifdef _WIN32
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
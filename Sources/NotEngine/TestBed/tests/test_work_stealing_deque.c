@@ -0,0 +1,122 @@
+﻿#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "core/data_structs/containers/work_stealing_deque.h"
+#include "tests.h"
+#include "test_thread.h"
+
+#define ITEM_COUNT 200000
+#define MAX_THIEVES 4
+
+// 所有者压入1..ITEM_COUNT，随机穿插pop；多个窃取者同时steal
+// 每个元素必须恰好被取走一次：重复说明pop与steal抢到了同一个元素，缺失说明元素丢失
+typedef struct StressState
+{
+    WorkStealingDeque deque;
+    atomic_int* taken_count;  // 每个元素被取走的次数，下标为元素值
+    atomic_long duplicates;
+    atomic_bool owner_done;   // 所有者已取完剩余元素，之后队列不会再有新元素
+} StressState;
+
+static void take_item(StressState* state, void* item)
+{
+    uintptr_t value = (uintptr_t)item;
+    if (atomic_fetch_add(&state->taken_count[value], 1) != 0)
+    {
+        atomic_fetch_add(&state->duplicates, 1);
+    }
+}
+
+static void thief_main(void* arg)
+{
+    StressState* state = arg;
+    for (;;)
+    {
+        // 先读标记再窃取：标记已置位且队列为空时不会再有元素
+        bool owner_done = atomic_load(&state->owner_done);
+        void* item;
+        StealResult result = ws_deque_steal(state->deque, &item);
+        if (result == STEAL_SUCCESS)
+        {
+            take_item(state, item);
+        }
+        else if (result == STEAL_EMPTY)
+        {
+            if (owner_done) break;
+            test_thread_yield();
+        }
+    }
+}
+
+static bool run_round(StressState* state, int thief_count, unsigned pop_period)
+{
+    for (size_t i = 0; i <= ITEM_COUNT; i++)
+    {
+        atomic_store(&state->taken_count[i], 0);
+    }
+    atomic_store(&state->duplicates, 0);
+    atomic_store(&state->owner_done, false);
+    // 初始容量很小，压测过程中会多次扩容
+    state->deque = ws_deque_create(2, NULL);
+
+    TestThread thieves[MAX_THIEVES];
+    int started = 0;
+    for (int i = 0; i < thief_count; i++)
+    {
+        if (test_thread_start(&thieves[i], thief_main, state)) started++;
+    }
+
+    unsigned random = 1;
+    for (uintptr_t value = 1; value <= ITEM_COUNT; value++)
+    {
+        ws_deque_push(state->deque, (void*)value);
+        random = random * 1103515245u + 12345u;
+        void* item;
+        if ((random >> 16) % pop_period == 0 && ws_deque_pop(state->deque, &item))
+        {
+            take_item(state, item);
+        }
+    }
+
+    // 所有者取完剩下的元素，窃取者看到队列为空后退出
+    void* item;
+    while (ws_deque_pop(state->deque, &item))
+    {
+        take_item(state, item);
+    }
+    atomic_store(&state->owner_done, true);
+    for (int i = 0; i < started; i++)
+    {
+        test_thread_join(&thieves[i]);
+    }
+    ws_deque_destroy(state->deque);
+
+    long missing = 0;
+    for (size_t i = 1; i <= ITEM_COUNT; i++)
+    {
+        if (atomic_load(&state->taken_count[i]) == 0) missing++;
+    }
+    long duplicates = atomic_load(&state->duplicates);
+    bool ok = started == thief_count && missing == 0 && duplicates == 0;
+    printf("[%s] ws_deque %d thieves, pop every ~%u pushes: %ld missing, %ld duplicates\n",
+        ok ? "PASS" : "FAIL", thief_count, pop_period, missing, duplicates);
+    return ok;
+}
+
+bool test_work_stealing_deque(void)
+{
+    StressState state;
+    state.taken_count = malloc((ITEM_COUNT + 1) * sizeof(atomic_int));
+    if (!state.taken_count) return false;
+
+    bool ok = true;
+    for (int thieves = 1; thieves <= MAX_THIEVES; thieves *= 2)
+    {
+        // pop频繁时所有者和窃取者经常争抢最后一个元素
+        ok &= run_round(&state, thieves, 2);
+        ok &= run_round(&state, thieves, 16);
+    }
+    free(state.taken_count);
+    return ok;
+}
@@ -0,0 +1,13 @@
+﻿#pragma once
+#include <stdbool.h>
+
+// 容器压力测试，全部通过返回true；失败原因输出到stdout
+bool test_work_stealing_deque(void);
+
+// 依次运行所有测试
+static inline bool run_tests(void)
+{
+    bool ok = true;
+    ok &= test_work_stealing_deque();
+    return ok;
+}